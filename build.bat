@@ -102,9 +102,11 @@ set SRCS=!SRCS! src\client\client.c
 set SRCS=!SRCS! src\log\log.c
 set SRCS=!SRCS! src\config\config.c
 set SRCS=!SRCS! src\security\failban.c
+set SRCS=!SRCS! src\security\authcache.c
 set SRCS=!SRCS! src\emu\emu.c
 set SRCS=!SRCS! src\srvid\srvid.c
 set SRCS=!SRCS! src\net\net.c
+set SRCS=!SRCS! src\net\engine.c
 set SRCS=!SRCS! src\cache\cw_cache.c
 set SRCS=!SRCS! src\platform\platform.c
 set SRCS=!SRCS! src\crypto\crypto.c
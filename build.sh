@@ -31,9 +31,11 @@ src/client/client.c \
 src/log/log.c \
 src/config/config.c \
 src/security/failban.c \
+src/security/authcache.c \
 src/emu/emu.c \
 src/srvid/srvid.c \
 src/net/net.c \
+src/net/engine.c \
 src/cache/cw_cache.c \
 src/platform/platform.c \
 src/crypto/crypto.c \
@@ -125,7 +127,7 @@ build_linux_native() {
     mkdir -p "$BUILD_DIR"
     build_direct "$GCC" "$BUILD_DIR/tcmg" \
         "$COMMON_FLAGS" \
-        "-lpthread -lm -Wl,--gc-sections -Wl,--strip-all -Wl,--build-id=none" \
+        "-lpthread -lm -lrt -Wl,--gc-sections -Wl,--strip-all -Wl,--build-id=none" \
         "strip"
 }
 
@@ -1,43 +1,1307 @@
 #define MODULE_LOG_PREFIX "cache"
 #include "../../globals.h"
 
-static inline uint32_t cw_idx(const uint8_t *md5)
+#if defined(__linux__) && !defined(__ANDROID__)
+#  define CW_HAVE_SHM 1
+#endif
+
+typedef struct {
+    _Atomic uint64_t locks;
+    _Atomic uint64_t contended;
+    _Atomic uint64_t wait_ns;
+} S_CW_SHARD_STAT;
+
+typedef struct S_CW_CACHE {
+    uint32_t           nsets;
+    uint32_t           ways;
+    uint32_t           nshards;
+    S_CW_CACHE_ENTRY  *entries;
+    _Atomic uint32_t  *seq;
+    uint8_t           *hand;
+    pthread_mutex_t   *mtx;
+    S_CW_SHARD_STAT   *sstat;
+    void              *shm_base;
+    size_t             shm_size;
+    char               shm_name[64];
+    uint32_t           grace;
+    struct S_CW_CACHE *retired;
+} S_CW_CACHE;
+
+typedef struct {
+    _Atomic uint32_t ready;
+    uint32_t         nsets;
+    uint32_t         ways;
+    uint32_t         nshards;
+    uint32_t         entry_size;
+    uint32_t         reserved[11];
+} S_CW_SHM_HDR;
+
+typedef enum {
+    CW_STAT_HIT = 0,
+    CW_STAT_MISS,
+    CW_STAT_EXPIRED,
+    CW_STAT_EVICT,
+    CW_STAT_WAIT_NS,
+    CW_STAT_COALESCED,
+    CW_STAT_NEGATIVE,
+    CW_STAT_N
+} e_cw_stat;
+
+typedef struct {
+    _Atomic uint32_t key;
+    _Atomic uint64_t n[CW_STAT_N];
+} S_CW_CAID_STAT;
+
+typedef struct {
+    _Atomic uint32_t key;
+    _Atomic uint32_t samples;
+    _Atomic int32_t  period_s;
+    _Atomic int32_t  lifetime_s;
+} S_CW_CAID_TTL;
+
+static S_CW_CAID_STAT          s_caid_stat[CW_CACHE_CAIDS];
+static __thread S_CW_CAID_STAT *s_stat_last;
+static S_CW_CAID_TTL           s_caid_ttl[CW_CACHE_CAIDS];
+static __thread S_CW_CAID_TTL  *s_ttl_last;
+
+static _Atomic(S_CW_CACHE *) s_cache = NULL;
+static pthread_rwlock_t s_cache_lock = PTHREAD_RWLOCK_INITIALIZER;
+static S_CW_CACHE      *s_retired = NULL;
+static pthread_mutex_t  s_retired_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+    _Atomic int32_t n[2];
+    uint8_t         pad[64 - 2 * sizeof(int32_t)];
+} S_CW_READERS;
+
+static S_CW_READERS          s_readers[CW_READER_STRIPES];
+static _Atomic uint32_t      s_rd_epoch = 0;
+static _Atomic uint32_t      s_rd_next  = 0;
+static __thread S_CW_READERS *s_rd_mine;
+static _Atomic int32_t  s_cache_ttl = CW_CACHE_TTL_S;
+static _Atomic uint32_t s_cache_gen = 1;
+
+static __thread S_CW_L1 s_l1;
+
+static inline time_t cw_now(void)
+{
+#ifdef CLOCK_REALTIME_COARSE
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return ts.tv_sec;
+#else
+    return time(NULL);
+#endif
+}
+
+static S_CW_CAID_STAT *cw_stat_slot(uint16_t caid)
+{
+    uint32_t key = (uint32_t)caid + 1;
+    S_CW_CAID_STAT *s = s_stat_last;
+
+    if (s && atomic_load_explicit(&s->key, memory_order_relaxed) == key)
+        return s;
+    for (int i = 0; i < CW_CACHE_CAIDS; i++)
+    {
+        uint32_t k = atomic_load_explicit(&s_caid_stat[i].key, memory_order_acquire);
+        if (k == 0 && atomic_compare_exchange_strong(&s_caid_stat[i].key, &k, key))
+            k = key;
+        if (k == key)
+            return s_stat_last = &s_caid_stat[i];
+    }
+    return NULL;
+}
+
+static inline void cw_stat_add(uint16_t caid, e_cw_stat stat, uint64_t v)
+{
+    S_CW_CAID_STAT *s = cw_stat_slot(caid);
+    if (s) atomic_fetch_add_explicit(&s->n[stat], v, memory_order_relaxed);
+}
+
+typedef struct {
+    uint16_t         caid;
+    uint16_t         sid;
+    uint32_t         cur_tag;
+    uint32_t         prev_tag;
+    time_t           cur_first, cur_last;
+    time_t           prev_first, prev_last;
+    _Atomic uint64_t seen;
+    _Atomic int8_t   busy;
+} S_CW_SID_TRACK;
+
+static S_CW_SID_TRACK s_sid_track[CW_TTL_SIDS];
+
+static int32_t ewma(int32_t avg, int32_t x, uint32_t n)
+{
+    return n == 0 ? x : avg + (x - avg) / 4;
+}
+
+static S_CW_CAID_TTL *cw_ttl_slot(uint16_t caid, bool claim)
+{
+    uint32_t key = (uint32_t)caid + 1;
+    S_CW_CAID_TTL *t = s_ttl_last;
+
+    if (t && atomic_load_explicit(&t->key, memory_order_relaxed) == key)
+        return t;
+    for (int i = 0; i < CW_CACHE_CAIDS; i++)
+    {
+        uint32_t k = atomic_load_explicit(&s_caid_ttl[i].key, memory_order_acquire);
+        if (k == 0 && claim && atomic_compare_exchange_strong(&s_caid_ttl[i].key, &k, key))
+            k = key;
+        if (k == key)
+            return s_ttl_last = &s_caid_ttl[i];
+    }
+    return NULL;
+}
+
+static int32_t cw_ttl_learned(const S_CW_CAID_TTL *t)
+{
+    int32_t lo = g_cfg.cw_cache_ttl_min, hi = g_cfg.cw_cache_ttl_max, ttl;
+    if (!g_cfg.cw_cache_ttl_adapt || !t ||
+        atomic_load_explicit(&t->samples, memory_order_acquire) < CW_TTL_MIN_SAMPLES)
+        return atomic_load_explicit(&s_cache_ttl, memory_order_relaxed);
+    ttl = atomic_load_explicit(&t->lifetime_s, memory_order_relaxed);
+    ttl = ttl + ttl / 4 + 2;
+    if (hi < lo) hi = lo;
+    return ttl < lo ? lo : ttl > hi ? hi : ttl;
+}
+
+static int32_t cw_ttl_for(uint16_t caid)
+{
+    int32_t ttl = cw_ttl_learned(cw_ttl_slot(caid, false));
+    return ttl > 0xFFFF ? 0xFFFF : ttl;
+}
+
+static void cw_ttl_sample(uint16_t caid, int32_t period, int32_t lifetime)
+{
+    S_CW_CAID_TTL *t = cw_ttl_slot(caid, true);
+    if (!t) return;
+    uint32_t n = atomic_load_explicit(&t->samples, memory_order_relaxed);
+    atomic_store_explicit(&t->period_s,
+                          ewma(atomic_load_explicit(&t->period_s, memory_order_relaxed), period, n),
+                          memory_order_relaxed);
+    atomic_store_explicit(&t->lifetime_s,
+                          ewma(atomic_load_explicit(&t->lifetime_s, memory_order_relaxed), lifetime, n),
+                          memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->samples, 1, memory_order_release);
+}
+
+static void cw_ttl_observe(uint16_t caid, uint16_t sid, const uint8_t *ecm_md5, time_t now)
+{
+    uint32_t tag  = rd_le32(ecm_md5);
+    uint64_t seen = (uint64_t)(uint32_t)now << 32 | tag;
+    S_CW_SID_TRACK *s = &s_sid_track[((uint32_t)caid * 2654435761u ^ sid) & (CW_TTL_SIDS - 1)];
+
+    if (atomic_load_explicit(&s->seen, memory_order_relaxed) == seen) return;
+    if (atomic_exchange_explicit(&s->busy, 1, memory_order_acquire)) return;
+    if (s->caid != caid || s->sid != sid || !s->cur_first)
+    {
+        s->caid       = caid;
+        s->sid        = sid;
+        s->cur_tag    = tag;
+        s->prev_tag   = 0;
+        s->cur_first  = s->cur_last = now;
+        s->prev_first = s->prev_last = 0;
+    }
+    else if (tag == s->cur_tag)
+        s->cur_last = now;
+    else if (s->prev_first && tag == s->prev_tag)
+        s->prev_last = now;
+    else
+    {
+        int32_t period = (int32_t)(now - s->cur_first);
+        if (s->prev_first && period > 0 && period <= CW_TTL_MAX_PERIOD_S)
+            cw_ttl_sample(caid, period, (int32_t)(s->prev_last - s->prev_first));
+        s->prev_tag   = s->cur_tag;
+        s->prev_first = s->cur_first;
+        s->prev_last  = s->cur_last;
+        s->cur_tag    = tag;
+        s->cur_first  = s->cur_last = now;
+    }
+    atomic_store_explicit(&s->seen, seen, memory_order_relaxed);
+    atomic_store_explicit(&s->busy, 0, memory_order_release);
+}
+
+int32_t cw_cache_caid_info(S_CW_CAID_INFO *out, int32_t max)
+{
+    int32_t n = 0;
+    for (int i = 0; i < CW_CACHE_CAIDS && n < max; i++)
+    {
+        const S_CW_CAID_STAT *s = &s_caid_stat[i];
+        uint32_t key = atomic_load_explicit(&s->key, memory_order_acquire);
+        if (!key) continue;
+        const S_CW_CAID_TTL *t = cw_ttl_slot((uint16_t)(key - 1), false);
+        memset(&out[n], 0, sizeof(out[n]));
+        out[n].caid         = (uint16_t)(key - 1);
+        out[n].ttl          = cw_ttl_learned(t);
+        out[n].hits         = atomic_load_explicit(&s->n[CW_STAT_HIT],     memory_order_relaxed);
+        out[n].misses       = atomic_load_explicit(&s->n[CW_STAT_MISS],    memory_order_relaxed);
+        out[n].expired      = atomic_load_explicit(&s->n[CW_STAT_EXPIRED], memory_order_relaxed);
+        out[n].evictions    = atomic_load_explicit(&s->n[CW_STAT_EVICT],   memory_order_relaxed);
+        out[n].lock_wait_us = atomic_load_explicit(&s->n[CW_STAT_WAIT_NS], memory_order_relaxed) / 1000;
+        out[n].coalesced    = atomic_load_explicit(&s->n[CW_STAT_COALESCED], memory_order_relaxed);
+        out[n].negative     = atomic_load_explicit(&s->n[CW_STAT_NEGATIVE],  memory_order_relaxed);
+        out[n].lookups      = out[n].hits + out[n].misses + out[n].coalesced + out[n].negative;
+        if (t)
+        {
+            out[n].period_s   = atomic_load_explicit(&t->period_s,   memory_order_relaxed);
+            out[n].lifetime_s = atomic_load_explicit(&t->lifetime_s, memory_order_relaxed);
+            out[n].samples    = atomic_load_explicit(&t->samples,    memory_order_relaxed);
+        }
+        n++;
+    }
+    return n;
+}
+
+int32_t cw_cache_shard_info(S_CW_SHARD_INFO *out, int32_t max)
+{
+    int32_t n = 0;
+    pthread_rwlock_rdlock(&s_cache_lock);
+    S_CW_CACHE *c = atomic_load_explicit(&s_cache, memory_order_relaxed);
+    for (uint32_t i = 0; c && i < c->nshards && n < max; i++, n++)
+    {
+        out[n].locks     = atomic_load_explicit(&c->sstat[i].locks,     memory_order_relaxed);
+        out[n].contended = atomic_load_explicit(&c->sstat[i].contended, memory_order_relaxed);
+        out[n].wait_us   = atomic_load_explicit(&c->sstat[i].wait_ns,   memory_order_relaxed) / 1000;
+    }
+    pthread_rwlock_unlock(&s_cache_lock);
+    return n;
+}
+
+void cw_cache_stats_reset(void)
+{
+    for (int i = 0; i < CW_CACHE_CAIDS; i++)
+    {
+        atomic_store_explicit(&s_caid_stat[i].key, 0, memory_order_release);
+        for (int j = 0; j < CW_STAT_N; j++)
+            atomic_store_explicit(&s_caid_stat[i].n[j], 0, memory_order_relaxed);
+    }
+    pthread_rwlock_rdlock(&s_cache_lock);
+    S_CW_CACHE *c = atomic_load_explicit(&s_cache, memory_order_relaxed);
+    for (uint32_t i = 0; c && i < c->nshards; i++)
+    {
+        atomic_store_explicit(&c->sstat[i].locks,     0, memory_order_relaxed);
+        atomic_store_explicit(&c->sstat[i].contended, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->sstat[i].wait_ns,   0, memory_order_relaxed);
+    }
+    pthread_rwlock_unlock(&s_cache_lock);
+}
+
+static inline uint64_t cw_mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint32_t cw_set(const S_CW_CACHE *c, const uint8_t *md5)
+{
+    return rd_le32(md5) & (c->nsets - 1);
+}
+
+static inline uint32_t pow2_ceil(uint32_t v)
+{
+    uint32_t p = 1;
+    while (p < v && p < 0x80000000u) p <<= 1;
+    return p;
+}
+
+static S_CW_CACHE_ENTRY *cw_victim(S_CW_CACHE *c, uint32_t set, const uint8_t *md5, time_t now)
+{
+    S_CW_CACHE_ENTRY *row = &c->entries[(size_t)set * c->ways];
+    S_CW_CACHE_ENTRY *freeslot = NULL;
+    uint32_t w;
+
+    for (w = 0; w < c->ways; w++)
+    {
+        S_CW_CACHE_ENTRY *e = &row[w];
+        if (e->valid && ct_memeq(e->ecm_md5, md5, 16))
+            return e;
+        if (!freeslot && (!e->valid || (now - e->ts) >= e->ttl))
+            freeslot = e;
+    }
+    if (freeslot) return freeslot;
+
+    for (;;)
+    {
+        S_CW_CACHE_ENTRY *e = &row[c->hand[set]];
+        c->hand[set] = (uint8_t)((c->hand[set] + 1) % c->ways);
+        if (!e->ref) return e;
+        e->ref = 0;
+    }
+}
+
+static void cw_put(S_CW_CACHE *c, uint32_t set, const uint8_t *md5,
+                   const uint8_t *cw, time_t ts, uint16_t ttl, uint16_t caid)
+{
+    _Atomic uint32_t *sq = &c->seq[set];
+    time_t now = cw_now();
+    S_CW_CACHE_ENTRY *e = cw_victim(c, set, md5, now);
+
+    if (e->valid && (now - e->ts) < e->ttl && !ct_memeq(e->ecm_md5, md5, 16))
+        cw_stat_add(e->caid, CW_STAT_EVICT, 1);
+
+    atomic_fetch_add_explicit(sq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(e->ecm_md5, md5, 16);
+    memcpy(e->cw,      cw,  CW_LEN);
+    e->ts    = ts;
+    e->ttl   = ttl;
+    e->caid  = caid;
+    e->valid = 1;
+    atomic_store_explicit(&e->ref, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(sq, 1, memory_order_release);
+}
+
+static S_CW_READERS *cw_read_begin(uint32_t *bucket)
+{
+    S_CW_READERS *r = s_rd_mine;
+    if (!r)
+        r = s_rd_mine = &s_readers[atomic_fetch_add_explicit(&s_rd_next, 1, memory_order_relaxed) %
+                                   CW_READER_STRIPES];
+    for (;;)
+    {
+        uint32_t e = atomic_load(&s_rd_epoch) & 1;
+        atomic_fetch_add(&r->n[e], 1);
+        if ((atomic_load(&s_rd_epoch) & 1) == e)
+        {
+            *bucket = e;
+            return r;
+        }
+        atomic_fetch_sub(&r->n[e], 1);
+    }
+}
+
+static inline void cw_read_end(S_CW_READERS *r, uint32_t bucket)
+{
+    atomic_fetch_sub(&r->n[bucket], 1);
+}
+
+static bool cw_grace_passed(uint32_t stamp)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        uint32_t e = atomic_load(&s_rd_epoch);
+        if (e - stamp >= 2) return true;
+        for (int k = 0; k < CW_READER_STRIPES; k++)
+            if (atomic_load(&s_readers[k].n[(e + 1) & 1]) > 0) return false;
+        atomic_compare_exchange_strong(&s_rd_epoch, &e, e + 1);
+    }
+    return atomic_load(&s_rd_epoch) - stamp >= 2;
+}
+
+static void cw_cache_retire(S_CW_CACHE *c)
+{
+    uint32_t i;
+    if (c->shm_base) return;
+    for (i = 0; i < c->nsets; i++)
+        atomic_store_explicit(&c->seq[i], 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    secure_zero(c->entries, (size_t)c->nsets * c->ways * sizeof(S_CW_CACHE_ENTRY));
+}
+
+static void cw_cache_destroy(S_CW_CACHE *c)
+{
+    while (c)
+    {
+        S_CW_CACHE *next = c->retired;
+        uint32_t i;
+        if (c->shm_base)
+        {
+#ifdef CW_HAVE_SHM
+            munmap(c->shm_base, c->shm_size);
+#endif
+        }
+        else
+        {
+            for (i = 0; i < c->nshards; i++)
+                pthread_mutex_destroy(&c->mtx[i]);
+            if (c->entries) secure_zero(c->entries, (size_t)c->nsets * c->ways * sizeof(S_CW_CACHE_ENTRY));
+            free(c->entries);
+            free(c->seq);
+            free(c->hand);
+            free(c->mtx);
+        }
+        free(c->sstat);
+        free(c);
+        c = next;
+    }
+}
+
+static S_CW_CACHE *cw_cache_create(uint32_t nsets, uint32_t ways, uint32_t nshards)
+{
+    S_CW_CACHE *c = calloc(1, sizeof(*c));
+    uint32_t i;
+    if (!c) return NULL;
+    c->nsets   = nsets;
+    c->ways    = ways;
+    c->entries = calloc((size_t)nsets * ways, sizeof(S_CW_CACHE_ENTRY));
+    c->seq     = calloc(nsets, sizeof(*c->seq));
+    c->hand    = calloc(nsets, 1);
+    c->mtx     = calloc(nshards, sizeof(pthread_mutex_t));
+    c->sstat   = calloc(nshards, sizeof(S_CW_SHARD_STAT));
+    if (!c->entries || !c->seq || !c->hand || !c->mtx || !c->sstat)
+    {
+        cw_cache_destroy(c);
+        return NULL;
+    }
+    for (i = 0; i < nshards; i++)
+        pthread_mutex_init(&c->mtx[i], NULL);
+    c->nshards = nshards;
+    return c;
+}
+
+#ifdef CW_HAVE_SHM
+static size_t cw_shm_layout(S_CW_CACHE *c, uint8_t *base)
+{
+    size_t seq_off  = sizeof(S_CW_SHM_HDR);
+    size_t hand_off = seq_off  + (((size_t)c->nsets * sizeof(uint32_t) + 63) & ~(size_t)63);
+    size_t mtx_off  = hand_off + (((size_t)c->nsets + 63) & ~(size_t)63);
+    size_t ent_off  = mtx_off  + (((size_t)c->nshards * sizeof(pthread_mutex_t) + 63) & ~(size_t)63);
+    if (base)
+    {
+        c->seq     = (_Atomic uint32_t *)(base + seq_off);
+        c->hand    = base + hand_off;
+        c->mtx     = (pthread_mutex_t *)(base + mtx_off);
+        c->entries = (S_CW_CACHE_ENTRY *)(base + ent_off);
+    }
+    return ent_off + (size_t)c->nsets * c->ways * sizeof(S_CW_CACHE_ENTRY);
+}
+
+static bool cw_shm_unlink_stale(const char *name, int fd)
+{
+    struct stat mine, cur;
+    bool same = false;
+    int fd2 = shm_open(name, O_RDWR, 0600);
+
+    if (fd2 < 0) return false;
+    if (fstat(fd, &mine) == 0 && fstat(fd2, &cur) == 0 &&
+        mine.st_dev == cur.st_dev && mine.st_ino == cur.st_ino)
+        same = true;
+    if (same && (size_t)cur.st_size >= sizeof(S_CW_SHM_HDR))
+    {
+        S_CW_SHM_HDR *hdr = mmap(NULL, sizeof(*hdr), PROT_READ, MAP_SHARED, fd2, 0);
+        if (hdr != MAP_FAILED)
+        {
+            same = atomic_load_explicit(&hdr->ready, memory_order_acquire) != CW_SHM_MAGIC;
+            munmap(hdr, sizeof(*hdr));
+        }
+    }
+    close(fd2);
+    return same && shm_unlink(name) == 0;
+}
+
+static S_CW_CACHE *cw_cache_create_shm(const char *name, uint32_t nsets, uint32_t ways, uint32_t nshards)
+{
+    S_CW_CACHE *c = calloc(1, sizeof(*c));
+    S_CW_SHM_HDR *hdr = NULL;
+    struct stat st;
+    bool creator, recreated = false;
+    uint8_t *base;
+    int fd, waited;
+
+    if (!c) return NULL;
+    snprintf(c->shm_name, sizeof(c->shm_name), "%s%s", name[0] == '/' ? "" : "/", name);
+
+retry:
+    creator = true;
+    base    = MAP_FAILED;
+    fd = shm_open(c->shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST)
+    {
+        creator = false;
+        fd = shm_open(c->shm_name, O_RDWR, 0600);
+    }
+    if (fd < 0)
+    {
+        tcmg_log("cw cache shm FAILED name=%s: %s", c->shm_name, strerror(errno));
+        free(c);
+        return NULL;
+    }
+
+    if (creator)
+    {
+        c->nsets   = nsets;
+        c->ways    = ways;
+        c->nshards = nshards;
+        c->shm_size = cw_shm_layout(c, NULL);
+        if (ftruncate(fd, (off_t)c->shm_size) == 0)
+            base = mmap(NULL, c->shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    else
+    {
+        for (waited = 0; waited < CW_SHM_ATTACH_MS; waited += 10)
+        {
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(S_CW_SHM_HDR))
+            {
+                base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (base != MAP_FAILED &&
+                    atomic_load_explicit(&((S_CW_SHM_HDR *)base)->ready, memory_order_acquire) == CW_SHM_MAGIC)
+                    break;
+                if (base != MAP_FAILED) munmap(base, (size_t)st.st_size);
+                base = MAP_FAILED;
+            }
+            tcmg_sleep_ms(10);
+        }
+        if (base == MAP_FAILED && !recreated && cw_shm_unlink_stale(c->shm_name, fd))
+        {
+            tcmg_log("cw cache shm name=%s was never initialised by its creator -- recreating",
+                     c->shm_name);
+            close(fd);
+            recreated = true;
+            goto retry;
+        }
+        if (base != MAP_FAILED)
+        {
+            hdr = (S_CW_SHM_HDR *)base;
+            c->nsets    = hdr->nsets;
+            c->ways     = hdr->ways;
+            c->nshards  = hdr->nshards;
+            c->shm_size = cw_shm_layout(c, NULL);
+            if (!c->nsets || !c->ways || !c->nshards || (c->nsets & (c->nsets - 1)) ||
+                (c->nshards & (c->nshards - 1)) || c->nshards > c->nsets ||
+                hdr->entry_size != sizeof(S_CW_CACHE_ENTRY) || c->shm_size != (size_t)st.st_size)
+            {
+                tcmg_log("cw cache shm name=%s has an incompatible layout -- not attaching", c->shm_name);
+                munmap(base, (size_t)st.st_size);
+                base = MAP_FAILED;
+            }
+            else if (c->nsets != nsets || c->ways != ways || c->nshards != nshards)
+                tcmg_log("cw cache shm name=%s WARNING: segment has entries=%u ways=%u shards=%u, "
+                         "config asks for entries=%u ways=%u shards=%u -- using the segment's layout",
+                         c->shm_name, c->nsets * c->ways, c->ways, c->nshards,
+                         nsets * ways, ways, nshards);
+        }
+    }
+    close(fd);
+
+    c->sstat = calloc(c->nshards ? c->nshards : 1, sizeof(S_CW_SHARD_STAT));
+    if (base == MAP_FAILED || !c->sstat)
+    {
+        if (base == MAP_FAILED)
+            tcmg_log("cw cache shm FAILED to map name=%s", c->shm_name);
+        if (creator) shm_unlink(c->shm_name);
+        free(c->sstat);
+        free(c);
+        return NULL;
+    }
+    c->shm_base = base;
+    cw_shm_layout(c, base);
+
+    if (creator)
+    {
+        pthread_mutexattr_t ma;
+        pthread_mutexattr_init(&ma);
+        pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST);
+        for (uint32_t i = 0; i < c->nshards; i++)
+            pthread_mutex_init(&c->mtx[i], &ma);
+        pthread_mutexattr_destroy(&ma);
+        hdr = (S_CW_SHM_HDR *)base;
+        hdr->nsets      = c->nsets;
+        hdr->ways       = c->ways;
+        hdr->nshards    = c->nshards;
+        hdr->entry_size = sizeof(S_CW_CACHE_ENTRY);
+        atomic_store_explicit(&hdr->ready, CW_SHM_MAGIC, memory_order_release);
+    }
+    tcmg_log("cw cache shm %s name=%s entries=%u ways=%u shards=%u",
+             creator ? "created" : "attached", c->shm_name,
+             c->nsets * c->ways, c->ways, c->nshards);
+    return c;
+}
+
+static void cw_shard_recover(S_CW_CACHE *c, uint32_t shard)
+{
+    for (uint32_t set = shard; set < c->nsets; set += c->nshards)
+    {
+        uint32_t s = atomic_load_explicit(&c->seq[set], memory_order_relaxed);
+        if (!(s & 1)) continue;
+        for (uint32_t w = 0; w < c->ways; w++)
+            c->entries[(size_t)set * c->ways + w].valid = 0;
+        atomic_store_explicit(&c->seq[set], s + 1, memory_order_release);
+    }
+    tcmg_log("cw cache shm shard=%u recovered from a dead lock owner", shard);
+}
+#endif
+
+static inline void cw_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+static bool cw_row_copy(const S_CW_CACHE *c, uint32_t set, S_CW_CACHE_ENTRY *row)
+{
+    _Atomic uint32_t *sq = &c->seq[set];
+    for (int tries = 0; tries < CW_SEQ_RETRIES; tries++)
+    {
+        uint32_t s0 = atomic_load_explicit(sq, memory_order_acquire);
+        if (s0 & 1)
+        {
+            cw_cpu_relax();
+            continue;
+        }
+        memcpy(row, &c->entries[(size_t)set * c->ways], c->ways * sizeof(*row));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(sq, memory_order_relaxed) == s0) return true;
+    }
+    return false;
+}
+
+static void cw_shard_lock(S_CW_CACHE *c, uint32_t shard, uint16_t caid)
+{
+    S_CW_SHARD_STAT *ss = &c->sstat[shard];
+    int rc = pthread_mutex_trylock(&c->mtx[shard]);
+
+    if (rc == EBUSY)
+    {
+        uint64_t t0 = cw_mono_ns(), waited;
+        rc = pthread_mutex_lock(&c->mtx[shard]);
+        waited = cw_mono_ns() - t0;
+        atomic_fetch_add_explicit(&ss->contended, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&ss->wait_ns, waited, memory_order_relaxed);
+        cw_stat_add(caid, CW_STAT_WAIT_NS, waited);
+    }
+#ifdef CW_HAVE_SHM
+    if (rc == EOWNERDEAD)
+    {
+        cw_shard_recover(c, shard);
+        pthread_mutex_consistent(&c->mtx[shard]);
+    }
+#endif
+    atomic_fetch_add_explicit(&ss->locks, 1, memory_order_relaxed);
+}
+
+bool cw_cache_configure(int32_t entries, int32_t ways, int32_t shards, int32_t ttl,
+                        const char *shm_name)
+{
+    uint32_t nways   = (uint32_t)(ways    < 1 ? 1 : ways > CW_CACHE_MAX_WAYS ? CW_CACHE_MAX_WAYS : ways);
+    uint32_t nsets   = pow2_ceil((uint32_t)(entries < 1 ? 1 : entries) / nways);
+    uint32_t nshards = pow2_ceil((uint32_t)(shards  < 1 ? 1 : shards));
+    S_CW_CACHE *nc = NULL, *old;
+    time_t now = cw_now();
+    bool use_shm = shm_name && shm_name[0];
+    bool same;
+
+    if (nsets < 1) nsets = 1;
+    if (nshards > nsets) nshards = nsets;
+    s_cache_ttl = ttl < 1 ? 1 : ttl;
+
+    pthread_rwlock_rdlock(&s_cache_lock);
+    old = s_cache;
+    if (use_shm)
+        same = old && old->shm_base &&
+               strcmp(old->shm_name + 1, shm_name[0] == '/' ? shm_name + 1 : shm_name) == 0;
+    else
+        same = old && !old->shm_base &&
+               old->nsets == nsets && old->ways == nways && old->nshards == nshards;
+    pthread_rwlock_unlock(&s_cache_lock);
+    if (same)
+    {
+        atomic_fetch_add_explicit(&s_cache_gen, 1, memory_order_release);
+        return true;
+    }
+
+    if (use_shm)
+    {
+#ifdef CW_HAVE_SHM
+        nc = cw_cache_create_shm(shm_name, nsets, nways, nshards);
+#else
+        tcmg_log("cw cache shm name=%s not supported on this platform", shm_name);
+#endif
+        if (!nc)
+            tcmg_log("%s", "cw cache shm unavailable -- using a private table");
+    }
+    if (!nc)
+        nc = cw_cache_create(nsets, nways, nshards);
+    if (!nc)
+    {
+        tcmg_log("cw cache resize FAILED entries=%u ways=%u -- keeping current table",
+                 nsets * nways, nways);
+        return false;
+    }
+
+    pthread_rwlock_wrlock(&s_cache_lock);
+    old = s_cache;
+    for (uint32_t os = 0; old && os < old->nsets; os++)
+    {
+        S_CW_CACHE_ENTRY row[CW_CACHE_MAX_WAYS];
+        if (!cw_row_copy(old, os, row)) continue;
+        for (uint32_t w = 0; w < old->ways; w++)
+        {
+            const S_CW_CACHE_ENTRY *e = &row[w];
+            if (!e->valid || (now - e->ts) >= e->ttl) continue;
+            uint32_t set = cw_set(nc, e->ecm_md5);
+            cw_shard_lock(nc, set & (nc->nshards - 1), e->caid);
+            cw_put(nc, set, e->ecm_md5, e->cw, e->ts, e->ttl, e->caid);
+            pthread_mutex_unlock(&nc->mtx[set & (nc->nshards - 1)]);
+        }
+        secure_zero(row, sizeof(row));
+    }
+    atomic_store(&s_cache, nc);
+    atomic_fetch_add_explicit(&s_cache_gen, 1, memory_order_release);
+    if (old)
+    {
+        cw_cache_retire(old);
+        old->grace = atomic_load(&s_rd_epoch);
+        pthread_mutex_lock(&s_retired_mtx);
+        old->retired = s_retired;
+        s_retired    = old;
+        pthread_mutex_unlock(&s_retired_mtx);
+    }
+    pthread_rwlock_unlock(&s_cache_lock);
+
+    tcmg_log("cw cache entries=%u sets=%u ways=%u shards=%u ttl=%ds%s",
+             nc->nsets * nc->ways, nc->nsets, nc->ways, nc->nshards, (int)s_cache_ttl,
+             nc->shm_base ? " (shared)" : "");
+    return true;
+}
+
+void cw_cache_reclaim(void)
+{
+    pthread_mutex_lock(&s_retired_mtx);
+    for (S_CW_CACHE **pp = &s_retired; *pp; )
+    {
+        S_CW_CACHE *c = *pp;
+        if (!cw_grace_passed(c->grace)) { pp = &c->retired; continue; }
+        *pp = c->retired;
+        c->retired = NULL;
+        cw_cache_destroy(c);
+    }
+    pthread_mutex_unlock(&s_retired_mtx);
+}
+
+void cw_cache_free(void)
+{
+    pthread_rwlock_wrlock(&s_cache_lock);
+    cw_cache_destroy(atomic_exchange(&s_cache, NULL));
+    atomic_fetch_add_explicit(&s_cache_gen, 1, memory_order_release);
+    pthread_rwlock_unlock(&s_cache_lock);
+    pthread_mutex_lock(&s_retired_mtx);
+    cw_cache_destroy(s_retired);
+    s_retired = NULL;
+    pthread_mutex_unlock(&s_retired_mtx);
+}
+
+typedef struct {
+    char     magic[8];
+    uint32_t count;
+    uint32_t entry_size;
+} S_CW_SNAP_HDR;
+
+typedef struct {
+    uint8_t  ecm_md5[16];
+    uint8_t  cw[CW_LEN];
+    int64_t  ts;
+    uint16_t ttl;
+    uint16_t caid;
+    uint32_t reserved;
+} S_CW_SNAP_ENTRY;
+
+int32_t cw_cache_save(const char *path)
+{
+#ifdef TCMG_OS_WINDOWS
+    (void)path;
+    return -1;
+#else
+    time_t now = cw_now();
+    size_t i, total, sz;
+    uint32_t n = 0;
+    uint8_t *m;
+    int fd;
+
+    pthread_rwlock_wrlock(&s_cache_lock);
+    S_CW_CACHE *c = atomic_load_explicit(&s_cache, memory_order_relaxed);
+    if (!c)
+    {
+        pthread_rwlock_unlock(&s_cache_lock);
+        return 0;
+    }
+    total = (size_t)c->nsets * c->ways;
+    for (i = 0; i < total; i++)
+        if (c->entries[i].valid && (now - c->entries[i].ts) < c->entries[i].ttl) n++;
+
+    sz = sizeof(S_CW_SNAP_HDR) + (size_t)n * sizeof(S_CW_SNAP_ENTRY);
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)sz) != 0)
+    {
+        tcmg_log("cw cache snapshot FAILED file=%s: %s", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        pthread_rwlock_unlock(&s_cache_lock);
+        return -1;
+    }
+    m = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+    {
+        tcmg_log("cw cache snapshot FAILED file=%s: %s", path, strerror(errno));
+        pthread_rwlock_unlock(&s_cache_lock);
+        unlink(path);
+        return -1;
+    }
+
+    S_CW_SNAP_HDR   *hdr = (S_CW_SNAP_HDR *)m;
+    S_CW_SNAP_ENTRY *out = (S_CW_SNAP_ENTRY *)(m + sizeof(*hdr));
+    uint32_t k = 0;
+    for (uint32_t set = 0; set < c->nsets && k < n; set++)
+    {
+        S_CW_CACHE_ENTRY row[CW_CACHE_MAX_WAYS];
+        if (!cw_row_copy(c, set, row)) continue;
+        for (uint32_t w = 0; w < c->ways && k < n; w++)
+        {
+            const S_CW_CACHE_ENTRY *e = &row[w];
+            if (!e->valid || (now - e->ts) >= e->ttl) continue;
+            memcpy(out[k].ecm_md5, e->ecm_md5, 16);
+            memcpy(out[k].cw,      e->cw,      CW_LEN);
+            out[k].ts   = (int64_t)e->ts;
+            out[k].ttl  = e->ttl;
+            out[k].caid = e->caid;
+            k++;
+        }
+        secure_zero(row, sizeof(row));
+    }
+    pthread_rwlock_unlock(&s_cache_lock);
+
+    hdr->count      = k;
+    hdr->entry_size = sizeof(S_CW_SNAP_ENTRY);
+    memcpy(hdr->magic, CW_SNAP_MAGIC, sizeof(hdr->magic));
+    msync(m, sz, MS_SYNC);
+    munmap(m, sz);
+    tcmg_log("cw cache snapshot saved entries=%u file=%s", k, path);
+    return (int32_t)k;
+#endif
+}
+
+int32_t cw_cache_load(const char *path)
+{
+#ifdef TCMG_OS_WINDOWS
+    (void)path;
+    return -1;
+#else
+    struct stat st;
+    time_t now = cw_now();
+    uint32_t i, n = 0, count;
+    uint8_t *m;
+    int fd = open(path, O_RDWR);
+
+    if (fd < 0) return 0;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(S_CW_SNAP_HDR))
+    {
+        close(fd);
+        unlink(path);
+        return 0;
+    }
+    m = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+    {
+        tcmg_log("cw cache snapshot FAILED to map file=%s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    const S_CW_SNAP_HDR   *hdr = (const S_CW_SNAP_HDR *)m;
+    const S_CW_SNAP_ENTRY *in  = (const S_CW_SNAP_ENTRY *)(m + sizeof(*hdr));
+    count = hdr->count;
+    if (memcmp(hdr->magic, CW_SNAP_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->entry_size != sizeof(S_CW_SNAP_ENTRY) ||
+        (size_t)st.st_size < sizeof(*hdr) + (size_t)count * sizeof(S_CW_SNAP_ENTRY))
+    {
+        tcmg_log("cw cache snapshot ignored -- bad header file=%s", path);
+        count = 0;
+    }
+
+    pthread_rwlock_rdlock(&s_cache_lock);
+    S_CW_CACHE *c = atomic_load_explicit(&s_cache, memory_order_relaxed);
+    for (i = 0; c && i < count; i++)
+    {
+        time_t ts = (time_t)in[i].ts;
+        if (ts > now || (now - ts) >= in[i].ttl) continue;
+        uint32_t set   = cw_set(c, in[i].ecm_md5);
+        uint32_t shard = set & (c->nshards - 1);
+        cw_shard_lock(c, shard, in[i].caid);
+        cw_put(c, set, in[i].ecm_md5, in[i].cw, ts, in[i].ttl, in[i].caid);
+        pthread_mutex_unlock(&c->mtx[shard]);
+        n++;
+    }
+    pthread_rwlock_unlock(&s_cache_lock);
+
+    secure_zero(m, (size_t)st.st_size);
+    munmap(m, (size_t)st.st_size);
+    unlink(path);
+    tcmg_log("cw cache snapshot restored entries=%u of %u file=%s", n, count, path);
+    return (int32_t)n;
+#endif
+}
+
+static bool cw_l1_lookup(S_CW_L1 *l1, const uint8_t *ecm_md5, uint8_t *cw_out)
+{
+    uint32_t gen = atomic_load_explicit(&s_cache_gen, memory_order_acquire);
+    time_t   now = cw_now();
+
+    for (int i = 0; i < CW_L1_WAYS; i++)
+    {
+        S_CW_L1_ENTRY *e = &l1->e[i];
+        if (!e->valid || memcmp(e->ecm_md5, ecm_md5, 16) != 0) continue;
+        if (e->gen != gen || now >= e->expires)
+        {
+            secure_zero(e, sizeof(*e));
+            return false;
+        }
+        memcpy(cw_out, e->cw, CW_LEN);
+        return true;
+    }
+    return false;
+}
+
+static void cw_l1_store(S_CW_L1 *l1, const uint8_t *ecm_md5, const uint8_t *cw, time_t expires)
+{
+    S_CW_L1_ENTRY *e = NULL;
+    for (int i = 0; i < CW_L1_WAYS && !e; i++)
+        if (!l1->e[i].valid || memcmp(l1->e[i].ecm_md5, ecm_md5, 16) == 0)
+            e = &l1->e[i];
+    if (!e)
+    {
+        e = &l1->e[l1->hand];
+        l1->hand = (uint8_t)((l1->hand + 1) % CW_L1_WAYS);
+    }
+    memcpy(e->ecm_md5, ecm_md5, 16);
+    memcpy(e->cw, cw, CW_LEN);
+    e->expires = expires;
+    e->gen     = atomic_load_explicit(&s_cache_gen, memory_order_acquire);
+    e->valid   = 1;
+}
+
+void cw_l1_flush(void)
+{
+    secure_zero(&s_l1, sizeof(s_l1));
+}
+
+static S_CW_CACHE_ENTRY *cw_row_find(S_CW_CACHE *c, uint32_t set, const uint8_t *ecm_md5,
+                                     time_t now, uint8_t *cw, time_t *expires, bool *old)
+{
+    S_CW_CACHE_ENTRY *row = &c->entries[(size_t)set * c->ways];
+
+    *old = false;
+    for (uint32_t w = 0; w < c->ways; w++)
+    {
+        S_CW_CACHE_ENTRY *e = &row[w];
+        if (!e->valid || !ct_memeq(e->ecm_md5, ecm_md5, 16)) continue;
+        if ((now - e->ts) >= e->ttl)
+        {
+            *old = true;
+            return NULL;
+        }
+        memcpy(cw, e->cw, CW_LEN);
+        *expires = e->ts + e->ttl;
+        return e;
+    }
+    return NULL;
+}
+
+static bool cw_l2_read(const uint8_t *ecm_md5, uint16_t caid, uint8_t *cw_out,
+                       time_t *exp_out, bool *stale)
+{
+    time_t now = cw_now();
+    S_CW_CACHE *c = NULL;
+    S_CW_CACHE_ENTRY *hit = NULL;
+    uint8_t cw[CW_LEN];
+    time_t expires = 0;
+    bool old = false;
+    uint32_t set = 0;
+    int tries;
+
+    *stale = false;
+    for (tries = 0; tries < CW_SEQ_RETRIES; tries++)
+    {
+        c = atomic_load_explicit(&s_cache, memory_order_acquire);
+        if (!c) return false;
+
+        set = cw_set(c, ecm_md5);
+        _Atomic uint32_t *sq = &c->seq[set];
+        uint32_t s0 = atomic_load_explicit(sq, memory_order_acquire);
+        if (s0 & 1)
+        {
+            cw_cpu_relax();
+            continue;
+        }
+        hit = cw_row_find(c, set, ecm_md5, now, cw, &expires, &old);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(sq, memory_order_relaxed) == s0) break;
+    }
+    if (tries == CW_SEQ_RETRIES)
+    {
+        uint32_t shard = set & (c->nshards - 1);
+        cw_shard_lock(c, shard, caid);
+        hit = cw_row_find(c, set, ecm_md5, now, cw, &expires, &old);
+        pthread_mutex_unlock(&c->mtx[shard]);
+    }
+
+    *stale = old;
+    if (!hit) return false;
+    memcpy(cw_out, cw, CW_LEN);
+    secure_zero(cw, sizeof(cw));
+    *exp_out = expires;
+    if (!atomic_load_explicit(&hit->ref, memory_order_relaxed))
+        atomic_store_explicit(&hit->ref, 1, memory_order_relaxed);
+    return true;
+}
+
+static bool cw_l2_lookup(const uint8_t *ecm_md5, uint16_t caid, uint8_t *cw_out,
+                         time_t *exp_out, bool *stale)
+{
+    uint32_t bucket;
+    S_CW_READERS *r = cw_read_begin(&bucket);
+    bool hit = cw_l2_read(ecm_md5, caid, cw_out, exp_out, stale);
+    cw_read_end(r, bucket);
+    return hit;
+}
+
+void cw_cache_store(const uint8_t *ecm_md5, uint16_t caid, const uint8_t *cw)
+{
+    uint16_t ttl = (uint16_t)cw_ttl_for(caid);
+    uint32_t set = 0, shard = 0;
+    pthread_rwlock_rdlock(&s_cache_lock);
+    S_CW_CACHE *c = atomic_load_explicit(&s_cache, memory_order_relaxed);
+    if (c)
+    {
+        set   = cw_set(c, ecm_md5);
+        shard = set & (c->nshards - 1);
+        cw_shard_lock(c, shard, caid);
+        cw_put(c, set, ecm_md5, cw, cw_now(), ttl, caid);
+        pthread_mutex_unlock(&c->mtx[shard]);
+    }
+    pthread_rwlock_unlock(&s_cache_lock);
+    tcmg_log_dbg(D_CCCAM|D_NEWCAMD, "cw cache stored caid=%04X ttl=%us set=%u shard=%u",
+                 caid, ttl, set, shard);
+}
+
+typedef struct {
+    uint8_t ecm_md5[16];
+    char    user[CFGKEY_LEN];
+    int32_t res;
+    time_t  ts;
+    int8_t  valid;
+} S_CW_NEG_ENTRY;
+
+static S_CW_NEG_ENTRY  s_neg[CW_NEG_CACHE_SIZE];
+static pthread_mutex_t s_neg_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static inline const char *cw_ctx_user(const S_ECM_CTX *ctx)
+{
+    return ctx ? ctx->user : "";
+}
+
+static S_CW_NEG_ENTRY *cw_neg_slot(const uint8_t *ecm_md5, const char *user)
 {
     uint32_t h = 2166136261u;
-    h = (h ^ md5[0]) * 16777619u;
-    h = (h ^ md5[1]) * 16777619u;
-    h = (h ^ md5[2]) * 16777619u;
-    h = (h ^ md5[3]) * 16777619u;
-    return h & (CW_CACHE_SIZE - 1);
+    for (const char *u = user; *u; u++)
+        h = (h ^ (uint8_t)*u) * 16777619u;
+    return &s_neg[(rd_le32(ecm_md5) ^ h) & (CW_NEG_CACHE_SIZE - 1)];
 }
 
-bool cw_cache_lookup(const uint8_t *ecm_md5, uint8_t *cw_out)
+static bool cw_neg_lookup(const uint8_t *ecm_md5, const char *user, int32_t *res)
 {
-    uint32_t idx   = cw_idx(ecm_md5);
-    uint32_t shard = idx & (CW_CACHE_SHARDS - 1);
+    int32_t ttl = g_cfg.cw_neg_ttl;
     bool hit = false;
-    pthread_mutex_lock(&g_cw_cache_mtx[shard]);
-    S_CW_CACHE_ENTRY *e = &g_cw_cache[idx];
-    if (e->valid && ct_memeq(e->ecm_md5, ecm_md5, 16) &&
-        (time(NULL) - e->ts) < CW_CACHE_TTL_S)
+    if (ttl <= 0) return false;
+    pthread_mutex_lock(&s_neg_mtx);
+    S_CW_NEG_ENTRY *e = cw_neg_slot(ecm_md5, user);
+    if (e->valid && strcmp(e->user, user) == 0 && memcmp(e->ecm_md5, ecm_md5, 16) == 0 &&
+        (cw_now() - e->ts) < ttl)
     {
-        memcpy(cw_out, e->cw, CW_LEN);
-        hit = true;
+        *res = e->res;
+        hit  = true;
     }
-    pthread_mutex_unlock(&g_cw_cache_mtx[shard]);
+    pthread_mutex_unlock(&s_neg_mtx);
     return hit;
 }
 
-void cw_cache_store(const uint8_t *ecm_md5, const uint8_t *cw)
+static void cw_neg_store(const uint8_t *ecm_md5, const char *user, int32_t res)
 {
-    uint32_t idx   = cw_idx(ecm_md5);
-    uint32_t shard = idx & (CW_CACHE_SHARDS - 1);
-    pthread_mutex_lock(&g_cw_cache_mtx[shard]);
-    S_CW_CACHE_ENTRY *e = &g_cw_cache[idx];
+    if (g_cfg.cw_neg_ttl <= 0) return;
+    if (res != EMU_KEY_NOT_FOUND && res != EMU_NOT_SUPPORTED && res != EMU_CHECKSUM_ERROR)
+        return;
+    pthread_mutex_lock(&s_neg_mtx);
+    S_CW_NEG_ENTRY *e = cw_neg_slot(ecm_md5, user);
     memcpy(e->ecm_md5, ecm_md5, 16);
-    memcpy(e->cw,      cw,      CW_LEN);
-    e->ts    = time(NULL);
+    tcmg_strlcpy(e->user, user, sizeof(e->user));
+    e->res   = res;
+    e->ts    = cw_now();
     e->valid = 1;
-    pthread_mutex_unlock(&g_cw_cache_mtx[shard]);
-    tcmg_log_dbg(D_CCCAM|D_NEWCAMD, "cw cache stored slot=%u shard=%u", idx, shard);
+    pthread_mutex_unlock(&s_neg_mtx);
+}
+
+void cw_neg_flush(void)
+{
+    pthread_mutex_lock(&s_neg_mtx);
+    memset(s_neg, 0, sizeof(s_neg));
+    pthread_mutex_unlock(&s_neg_mtx);
+}
+
+typedef struct {
+    uint8_t        ecm_md5[16];
+    uint8_t        cw[CW_LEN];
+    char           user[CFGKEY_LEN];
+    int32_t        res;
+    int32_t        refs;
+    int8_t         used;
+    int8_t         done;
+    pthread_cond_t cond;
+} S_CW_FLIGHT;
+
+static S_CW_FLIGHT     s_flight[CW_FLIGHT_SLOTS];
+static pthread_mutex_t s_flight_mtx  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  s_flight_once = PTHREAD_ONCE_INIT;
+
+static void cw_flight_init(void)
+{
+    for (int i = 0; i < CW_FLIGHT_SLOTS; i++)
+        pthread_cond_init(&s_flight[i].cond, NULL);
+}
+
+static void cw_flight_release_locked(S_CW_FLIGHT *f)
+{
+    if (--f->refs > 0) return;
+    secure_zero(f->cw, CW_LEN);
+    f->used = 0;
+}
+
+static bool cw_flight_wait_locked(S_CW_FLIGHT *f)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += CW_FLIGHT_WAIT_MS / 1000;
+    ts.tv_nsec += (long)(CW_FLIGHT_WAIT_MS % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    while (!f->done)
+        if (pthread_cond_timedwait(&f->cond, &s_flight_mtx, &ts) == ETIMEDOUT)
+            break;
+    return f->done;
+}
+
+int32_t cw_cache_probe(const uint8_t *ecm_md5, uint16_t caid, uint16_t sid,
+                       uint8_t *cw, const S_ECM_CTX *ctx, uint8_t *src)
+{
+    const char *user = cw_ctx_user(ctx);
+    S_CW_L1 *l1 = ctx && ctx->l1 ? ctx->l1 : &s_l1;
+    int32_t res;
+    time_t expires;
+    bool stale;
+
+    cw_ttl_observe(caid, sid, ecm_md5, cw_now());
+    if (cw_l1_lookup(l1, ecm_md5, cw))
+    {
+        cw_stat_add(caid, CW_STAT_HIT, 1);
+        *src = CW_SRC_L1;
+        return EMU_OK;
+    }
+    if (cw_l2_lookup(ecm_md5, caid, cw, &expires, &stale))
+    {
+        cw_stat_add(caid, CW_STAT_HIT, 1);
+        cw_l1_store(l1, ecm_md5, cw, expires);
+        *src = CW_SRC_CACHE;
+        return EMU_OK;
+    }
+    if (stale) cw_stat_add(caid, CW_STAT_EXPIRED, 1);
+    if (cw_neg_lookup(ecm_md5, user, &res))
+    {
+        cw_stat_add(caid, CW_STAT_NEGATIVE, 1);
+        *src = CW_SRC_NEGATIVE;
+        return res;
+    }
+    return CW_PROBE_MISS;
+}
+
+int32_t cw_cache_decode(const uint8_t *ecm_md5, uint16_t caid, uint16_t sid,
+                        const uint8_t *ecm, int32_t ecm_len,
+                        uint8_t *cw, const S_ECM_CTX *ctx, uint8_t *src)
+{
+    S_CW_FLIGHT *f = NULL, *slot = NULL;
+    const char *user = cw_ctx_user(ctx);
+    int32_t res;
+    time_t expires;
+    bool stale;
+    int i;
+
+    pthread_once(&s_flight_once, cw_flight_init);
+    pthread_mutex_lock(&s_flight_mtx);
+    for (i = 0; i < CW_FLIGHT_SLOTS; i++)
+    {
+        S_CW_FLIGHT *e = &s_flight[i];
+        if (e->used && memcmp(e->ecm_md5, ecm_md5, 16) == 0) { f = e; break; }
+        if (!e->used && !slot) slot = e;
+    }
+    if (f)
+    {
+        f->refs++;
+        bool done = cw_flight_wait_locked(f) && (f->res == EMU_OK || strcmp(f->user, user) == 0);
+        if (done)
+        {
+            res = f->res;
+            memcpy(cw, f->cw, CW_LEN);
+        }
+        cw_flight_release_locked(f);
+        pthread_mutex_unlock(&s_flight_mtx);
+        if (done)
+        {
+            cw_stat_add(caid, CW_STAT_COALESCED, 1);
+            *src = CW_SRC_COALESCED;
+            return res;
+        }
+        tcmg_log_dbg(D_ECM, "in-flight ECM caid=%04X sid=%04X not shareable -- decoding locally",
+                     caid, sid);
+    }
+    else if (slot)
+    {
+        memcpy(slot->ecm_md5, ecm_md5, 16);
+        tcmg_strlcpy(slot->user, user, sizeof(slot->user));
+        slot->used = 1;
+        slot->done = 0;
+        slot->refs = 1;
+        f = slot;
+        pthread_mutex_unlock(&s_flight_mtx);
+    }
+    else
+        pthread_mutex_unlock(&s_flight_mtx);
+
+    *src = CW_SRC_EMU;
+    if (f == slot && cw_l2_lookup(ecm_md5, caid, cw, &expires, &stale))
+    {
+        cw_stat_add(caid, CW_STAT_HIT, 1);
+        *src = CW_SRC_CACHE;
+        res  = EMU_OK;
+    }
+    else
+    {
+        cw_stat_add(caid, CW_STAT_MISS, 1);
+        res = emu_process(caid, sid, ecm, ecm_len, cw, ctx);
+        if (res == EMU_OK)
+            cw_cache_store(ecm_md5, caid, cw);
+        else
+            cw_neg_store(ecm_md5, user, res);
+    }
+
+    if (f && f == slot)
+    {
+        pthread_mutex_lock(&s_flight_mtx);
+        f->res  = res;
+        f->done = 1;
+        memcpy(f->cw, cw, CW_LEN);
+        pthread_cond_broadcast(&f->cond);
+        cw_flight_release_locked(f);
+        pthread_mutex_unlock(&s_flight_mtx);
+    }
+    return res;
+}
+
+int32_t cw_cache_resolve(const uint8_t *ecm_md5, uint16_t caid, uint16_t sid,
+                         const uint8_t *ecm, int32_t ecm_len,
+                         uint8_t *cw, const S_ECM_CTX *ctx, uint8_t *src)
+{
+    int32_t res = cw_cache_probe(ecm_md5, caid, sid, cw, ctx, src);
+    if (res != CW_PROBE_MISS) return res;
+    return cw_cache_decode(ecm_md5, caid, sid, ecm, ecm_len, cw, ctx, src);
 }
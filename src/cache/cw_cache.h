@@ -1,7 +1,25 @@
 #ifndef TCMG_CW_CACHE_H_
 #define TCMG_CW_CACHE_H_
 
-bool cw_cache_lookup(const uint8_t *ecm_md5, uint8_t *cw_out);
-void cw_cache_store(const uint8_t *ecm_md5, const uint8_t *cw);
+bool cw_cache_configure(int32_t entries, int32_t ways, int32_t shards, int32_t ttl,
+                        const char *shm_name);
+void cw_cache_free(void);
+void cw_cache_reclaim(void);
+int32_t cw_cache_save(const char *path);
+int32_t cw_cache_load(const char *path);
+void cw_cache_store(const uint8_t *ecm_md5, uint16_t caid, const uint8_t *cw);
+int32_t cw_cache_caid_info(S_CW_CAID_INFO *out, int32_t max);
+int32_t cw_cache_shard_info(S_CW_SHARD_INFO *out, int32_t max);
+void cw_cache_stats_reset(void);
+void cw_neg_flush(void);
+void cw_l1_flush(void);
+int32_t cw_cache_probe(const uint8_t *ecm_md5, uint16_t caid, uint16_t sid,
+                       uint8_t *cw, const S_ECM_CTX *ctx, uint8_t *src);
+int32_t cw_cache_decode(const uint8_t *ecm_md5, uint16_t caid, uint16_t sid,
+                        const uint8_t *ecm, int32_t ecm_len,
+                        uint8_t *cw, const S_ECM_CTX *ctx, uint8_t *src);
+int32_t cw_cache_resolve(const uint8_t *ecm_md5, uint16_t caid, uint16_t sid,
+                         const uint8_t *ecm, int32_t ecm_len,
+                         uint8_t *cw, const S_ECM_CTX *ctx, uint8_t *src);
 
 #endif
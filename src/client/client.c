@@ -1,62 +1,293 @@
 #define MODULE_LOG_PREFIX "client"
 #include "../../globals.h"
 
+typedef struct s_client_tab {
+	int32_t              cap;
+	uint32_t             grace;
+	struct s_client_tab *retired;
+	_Atomic(S_CLIENT *)  slot[];
+} S_CLIENT_TAB;
 
-void client_register(S_CLIENT *cl)
+static pthread_mutex_t         s_reg_mtx   = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic(S_CLIENT_TAB *) s_tab       = NULL;
+static int32_t                *s_free      = NULL;
+static int32_t                 s_nfree     = 0;
+static S_CLIENT              **s_by_id     = NULL;
+static S_CLIENT              **s_by_user   = NULL;
+static S_CLIENT_TAB           *s_retired   = NULL;
+static S_ACCOUNT              *s_acc_retired = NULL;
+
+static _Atomic uint32_t        s_rd_epoch  = 0;
+static _Atomic int32_t         s_rd_count[2];
+
+static inline uint32_t reg_id_bucket(uint32_t tid, int32_t cap)
+{
+	return (tid * 2654435761u) & (uint32_t)(cap - 1);
+}
+
+static inline uint32_t reg_user_bucket(const char *u, int32_t cap)
 {
-	pthread_mutex_lock(&g_clients_mtx);
-	for (int i = 0; i < MAX_ACTIVE_CLIENTS; i++)
-		if (!g_clients[i]) { g_clients[i] = cl; break; }
-	pthread_mutex_unlock(&g_clients_mtx);
+	uint32_t h = 2166136261u;
+	for (; *u; u++)
+		h = (h ^ (uint8_t)*u) * 16777619u;
+	return h & (uint32_t)(cap - 1);
+}
+
+static uint32_t reg_read_begin(void)
+{
+	for (;;)
+	{
+		uint32_t e = atomic_load(&s_rd_epoch) & 1;
+		atomic_fetch_add(&s_rd_count[e], 1);
+		if ((atomic_load(&s_rd_epoch) & 1) == e)
+			return e;
+		atomic_fetch_sub(&s_rd_count[e], 1);
+	}
+}
+
+static void reg_read_end(uint32_t e)
+{
+	atomic_fetch_sub(&s_rd_count[e], 1);
+}
+
+uint32_t clients_grace_stamp(void)
+{
+	return atomic_load(&s_rd_epoch);
+}
+
+bool clients_grace_passed(uint32_t stamp)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		uint32_t e = atomic_load(&s_rd_epoch);
+		if (e - stamp >= 2) return true;
+		if (atomic_load(&s_rd_count[(e + 1) & 1]) > 0) return false;
+		atomic_compare_exchange_strong(&s_rd_epoch, &e, e + 1);
+	}
+	return atomic_load(&s_rd_epoch) - stamp >= 2;
+}
+
+static void reg_unlink_user(S_CLIENT *cl, int32_t cap)
+{
+	S_CLIENT **pp = &s_by_user[reg_user_bucket(cl->user, cap)];
+	while (*pp && *pp != cl) pp = &(*pp)->user_next;
+	if (*pp) *pp = cl->user_next;
+	cl->user_next = NULL;
+}
+
+static bool reg_grow(void)
+{
+	S_CLIENT_TAB *old = atomic_load(&s_tab);
+	int32_t       cap = old ? old->cap * 2 : CLIENT_REG_INIT;
+
+	S_CLIENT_TAB *tab   = (S_CLIENT_TAB *)tcmg_malloc(sizeof(*tab) + sizeof(tab->slot[0]) * (size_t)cap);
+	int32_t      *fr    = (int32_t *)malloc(sizeof(int32_t) * (size_t)cap);
+	S_CLIENT    **by_id = (S_CLIENT **)tcmg_malloc(sizeof(S_CLIENT *) * (size_t)cap);
+	S_CLIENT    **by_us = (S_CLIENT **)tcmg_malloc(sizeof(S_CLIENT *) * (size_t)cap);
+	if (!tab || !fr || !by_id || !by_us)
+	{
+		free(tab); free(fr); free(by_id); free(by_us);
+		return false;
+	}
+
+	tab->cap = cap;
+	for (int32_t i = 1; i < (old ? old->cap : 0); i++)
+	{
+		S_CLIENT *cl = atomic_load_explicit(&old->slot[i], memory_order_relaxed);
+		atomic_store_explicit(&tab->slot[i], cl, memory_order_relaxed);
+		if (!cl) continue;
+		uint32_t b = reg_id_bucket(cl->thread_id, cap);
+		cl->id_next = by_id[b];
+		by_id[b]    = cl;
+		if (cl->user[0])
+		{
+			b = reg_user_bucket(cl->user, cap);
+			cl->user_next = by_us[b];
+			by_us[b]      = cl;
+		}
+	}
+	s_nfree = 0;
+	for (int32_t i = cap - 1; i >= (old ? old->cap : 1); i--)
+		fr[s_nfree++] = i;
+
+	free(s_free);
+	free(s_by_id);
+	free(s_by_user);
+	s_free    = fr;
+	s_by_id   = by_id;
+	s_by_user = by_us;
+	atomic_store(&s_tab, tab);
+
+	if (old)
+	{
+		old->grace   = clients_grace_stamp();
+		old->retired = s_retired;
+		s_retired    = old;
+	}
+	tcmg_log_dbg(D_CONN, "client registry grown to %d slots", cap);
+	return true;
+}
+
+bool client_register(S_CLIENT *cl)
+{
+	pthread_mutex_lock(&s_reg_mtx);
+	if (s_nfree == 0 && !reg_grow())
+	{
+		pthread_mutex_unlock(&s_reg_mtx);
+		return false;
+	}
+
+	S_CLIENT_TAB *tab = atomic_load_explicit(&s_tab, memory_order_relaxed);
+	uint32_t      b   = reg_id_bucket(cl->thread_id, tab->cap);
+
+	cl->slot      = s_free[--s_nfree];
+	cl->id_next   = s_by_id[b];
+	cl->user_next = NULL;
+	s_by_id[b]    = cl;
+	if (cl->user[0])
+	{
+		b = reg_user_bucket(cl->user, tab->cap);
+		cl->user_next = s_by_user[b];
+		s_by_user[b]  = cl;
+	}
+	atomic_store(&tab->slot[cl->slot], cl);
+	pthread_mutex_unlock(&s_reg_mtx);
+	return true;
 }
 
 void client_unregister(S_CLIENT *cl)
 {
-	pthread_mutex_lock(&g_clients_mtx);
-	for (int i = 0; i < MAX_ACTIVE_CLIENTS; i++)
-		if (g_clients[i] == cl) { g_clients[i] = NULL; break; }
-	pthread_mutex_unlock(&g_clients_mtx);
-	if (cl) {
-		secure_zero(cl->session_key, sizeof(cl->session_key));
-		secure_zero(cl->key1, sizeof(cl->key1));
-		secure_zero(cl->key2, sizeof(cl->key2));
-		secure_zero(cl->recv_buf, sizeof(cl->recv_buf));
-		secure_zero(cl->send_buf, sizeof(cl->send_buf));
+	if (!cl) return;
+
+	if (cl->slot)
+	{
+		pthread_mutex_lock(&s_reg_mtx);
+		S_CLIENT_TAB *tab = atomic_load_explicit(&s_tab, memory_order_relaxed);
+		S_CLIENT    **pp  = &s_by_id[reg_id_bucket(cl->thread_id, tab->cap)];
+
+		atomic_store(&tab->slot[cl->slot], NULL);
+		s_free[s_nfree++] = cl->slot;
+		cl->slot = 0;
+		while (*pp && *pp != cl) pp = &(*pp)->id_next;
+		if (*pp) *pp = cl->id_next;
+		cl->id_next = NULL;
+		if (cl->user[0]) reg_unlink_user(cl, tab->cap);
+		pthread_mutex_unlock(&s_reg_mtx);
 	}
+
+	secure_zero(cl->session_key, sizeof(cl->session_key));
+	secure_zero(&cl->ks, sizeof(cl->ks));
+	secure_zero(cl->send_buf, sizeof(cl->send_buf));
+}
+
+void client_set_user(S_CLIENT *cl, const char *user)
+{
+	pthread_mutex_lock(&s_reg_mtx);
+	S_CLIENT_TAB *tab = atomic_load_explicit(&s_tab, memory_order_relaxed);
+	if (cl->slot && cl->user[0]) reg_unlink_user(cl, tab->cap);
+	tcmg_strlcpy(cl->user, user, CFGKEY_LEN);
+	if (cl->slot && cl->user[0])
+	{
+		uint32_t b = reg_user_bucket(cl->user, tab->cap);
+		cl->user_next = s_by_user[b];
+		s_by_user[b]  = cl;
+	}
+	pthread_mutex_unlock(&s_reg_mtx);
 }
 
 void client_kill_by_tid(uint32_t tid)
 {
-	pthread_mutex_lock(&g_clients_mtx);
-	for (int i = 0; i < MAX_ACTIVE_CLIENTS; i++)
-		if (g_clients[i] && g_clients[i]->thread_id == tid)
-			{ g_clients[i]->kill_flag = 1; break; }
-	pthread_mutex_unlock(&g_clients_mtx);
+	pthread_mutex_lock(&s_reg_mtx);
+	S_CLIENT_TAB *tab = atomic_load_explicit(&s_tab, memory_order_relaxed);
+	if (tab)
+		for (S_CLIENT *cl = s_by_id[reg_id_bucket(tid, tab->cap)]; cl; cl = cl->id_next)
+			if (cl->thread_id == tid) { cl->kill_flag = 1; break; }
+	pthread_mutex_unlock(&s_reg_mtx);
 }
 
 void client_kill_by_user(const char *username)
 {
-	pthread_mutex_lock(&g_clients_mtx);
-	for (int i = 0; i < MAX_ACTIVE_CLIENTS; i++)
-		if (g_clients[i] && strcmp(g_clients[i]->user, username) == 0)
-			g_clients[i]->kill_flag = 1;
-	pthread_mutex_unlock(&g_clients_mtx);
+	pthread_mutex_lock(&s_reg_mtx);
+	S_CLIENT_TAB *tab = atomic_load_explicit(&s_tab, memory_order_relaxed);
+	if (tab && username[0])
+		for (S_CLIENT *cl = s_by_user[reg_user_bucket(username, tab->cap)]; cl; cl = cl->user_next)
+			if (strcmp(cl->user, username) == 0)
+				cl->kill_flag = 1;
+	pthread_mutex_unlock(&s_reg_mtx);
 }
 
-void clients_relink_accounts(void)
+static S_ACCOUNT *client_current_account(S_CLIENT *cl)
 {
-	pthread_mutex_lock(&g_clients_mtx);
-	pthread_rwlock_rdlock(&g_cfg.acc_lock);
-	for (int i = 0; i < MAX_ACTIVE_CLIENTS; i++)
+	S_ACCOUNT *old = cl->account;
+	S_ACCOUNT *a   = cfg_find_account(old->user);
+	if (a && a != old)
 	{
-		S_CLIENT *cl = g_clients[i];
-		if (!cl || !cl->user[0]) continue;
-		S_ACCOUNT *a;
-		for (a = g_cfg.accounts; a; a = a->next)
-			if (strcmp(cl->user, a->user) == 0) break;
-		cl->account = a;
-		if (!a) cl->kill_flag = 1;
+		cl->account = cfg_account_ref(a);
+		cfg_account_release(old);
 	}
+	return a;
+}
+
+void client_relink_account(S_CLIENT *cl)
+{
+	uint32_t gen = atomic_load(&g_acc_gen);
+	if (cl->acc_gen == gen) return;
+	cl->acc_gen = gen;
+	if (!cl->account) return;
+
+	pthread_rwlock_rdlock(&g_cfg.acc_lock);
+	if (!client_current_account(cl))
+		cl->kill_flag = 1;
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
-	pthread_mutex_unlock(&g_clients_mtx);
+}
+
+void client_drop_account(S_CLIENT *cl)
+{
+	if (!cl->account) return;
+	pthread_rwlock_rdlock(&g_cfg.acc_lock);
+	client_current_account(cl);
+	atomic_fetch_sub(&cl->account->active, 1);
+	pthread_rwlock_unlock(&g_cfg.acc_lock);
+}
+
+void clients_retire_account(S_ACCOUNT *a)
+{
+	pthread_mutex_lock(&s_reg_mtx);
+	a->grace      = clients_grace_stamp();
+	a->next       = s_acc_retired;
+	s_acc_retired = a;
+	pthread_mutex_unlock(&s_reg_mtx);
+}
+
+void clients_reclaim(void)
+{
+	pthread_mutex_lock(&s_reg_mtx);
+	for (S_CLIENT_TAB **pp = &s_retired; *pp; )
+	{
+		S_CLIENT_TAB *t = *pp;
+		if (!clients_grace_passed(t->grace)) { pp = &t->retired; continue; }
+		*pp = t->retired;
+		free(t);
+	}
+	for (S_ACCOUNT **pp = &s_acc_retired; *pp; )
+	{
+		S_ACCOUNT *a = *pp;
+		if (!clients_grace_passed(a->grace)) { pp = &a->next; continue; }
+		*pp = a->next;
+		cfg_account_free(a);
+	}
+	pthread_mutex_unlock(&s_reg_mtx);
+}
+
+void clients_foreach(void (*fn)(S_CLIENT *cl, void *arg), void *arg)
+{
+	uint32_t      e   = reg_read_begin();
+	S_CLIENT_TAB *tab = atomic_load(&s_tab);
+
+	for (int32_t i = 1; tab && i < tab->cap; i++)
+	{
+		S_CLIENT *cl = atomic_load_explicit(&tab->slot[i], memory_order_acquire);
+		if (cl) fn(cl, arg);
+	}
+	reg_read_end(e);
 }
@@ -3,10 +3,17 @@
 
 #include "../../globals.h"
 
-void client_register(S_CLIENT *cl);
+bool client_register(S_CLIENT *cl);
 void client_unregister(S_CLIENT *cl);
+void client_set_user(S_CLIENT *cl, const char *user);
 void client_kill_by_tid(uint32_t tid);
 void client_kill_by_user(const char *username);
-void clients_relink_accounts(void);
+void client_relink_account(S_CLIENT *cl);
+void client_drop_account(S_CLIENT *cl);
+void clients_retire_account(S_ACCOUNT *a);
+void clients_foreach(void (*fn)(S_CLIENT *cl, void *arg), void *arg);
+uint32_t clients_grace_stamp(void);
+bool clients_grace_passed(uint32_t stamp);
+void clients_reclaim(void);
 
 #endif
@@ -10,9 +10,29 @@ const S_CFG_FIELD cfg_server_fields[] =
 	DEF_OPT_INT8 ("NEWCAMD_MGCLIENT", S_CONFIG, newcamd_mgclient,    0              ),
 	DEF_OPT_INT32("CCCAM_PORT",       S_CONFIG, cccam_port,          12050, 0, 65535),
 	DEF_OPT_INT32("SOCKET_TIMEOUT",   S_CONFIG, sock_timeout,        30,    5, 600  ),
+	DEF_OPT_INT32("MAX_CLIENTS",      S_CONFIG, max_clients,         MAX_CLIENTS_DEFAULT, 1, MAX_CLIENTS_LIMIT),
+	DEF_OPT_INT32("IO_THREADS",       S_CONFIG, io_threads,          0,     0, IO_THREADS_MAX),
+	DEF_OPT_STR  ("IO_BACKEND",       S_CONFIG, io_backend,          "epoll"        ),
+	DEF_OPT_INT32("ACCEPT_THREADS",   S_CONFIG, accept_threads,      1,     0, ACCEPT_THREADS_MAX),
+	DEF_OPT_INT32("ECM_WORKERS",      S_CONFIG, ecm_workers,         0,     0, ECM_WORKERS_MAX),
+	DEF_OPT_INT32("ECM_INFLIGHT",     S_CONFIG, ecm_inflight,        8,     1, ECM_INFLIGHT_MAX),
+	DEF_OPT_INT32("ECM_BUDGET_MS",    S_CONFIG, ecm_budget_ms,       3000,  100, 30000),
+	DEF_OPT_INT32("ADMIT_LATENCY_MS", S_CONFIG, admit_latency_ms,    2000,  0, 30000),
+	DEF_OPT_INT32("ADMIT_QUEUE",      S_CONFIG, admit_queue,         1024,  0, 65535),
 	DEF_OPT_INT8 ("ECM_LOG",          S_CONFIG, ecm_log,             1              ),
 	DEF_OPT_STR  ("LOGFILE",          S_CONFIG, logfile,             ""             ),
 	DEF_OPT_STR  ("USRFILE",          S_CONFIG, usrfile,             ""             ),
+	DEF_OPT_STR  ("CRYPTO_KERNEL",    S_CONFIG, crypto_kernel,       "auto"         ),
+	DEF_OPT_INT32("CW_CACHE_ENTRIES", S_CONFIG, cw_cache_entries,    CW_CACHE_SIZE,   16, 1048576),
+	DEF_OPT_INT32("CW_CACHE_WAYS",    S_CONFIG, cw_cache_ways,       CW_CACHE_WAYS,   1, CW_CACHE_MAX_WAYS),
+	DEF_OPT_INT32("CW_CACHE_SHARDS",  S_CONFIG, cw_cache_shards,     CW_CACHE_SHARDS, 1, 256),
+	DEF_OPT_INT32("CW_CACHE_TTL",     S_CONFIG, cw_cache_ttl,        CW_CACHE_TTL_S,  1, 3600),
+	DEF_OPT_INT8 ("CW_CACHE_TTL_ADAPT",S_CONFIG, cw_cache_ttl_adapt, 1              ),
+	DEF_OPT_INT32("CW_CACHE_TTL_MIN", S_CONFIG, cw_cache_ttl_min,    CW_CACHE_TTL_MIN_S, 1, 3600),
+	DEF_OPT_INT32("CW_CACHE_TTL_MAX", S_CONFIG, cw_cache_ttl_max,    CW_CACHE_TTL_MAX_S, 1, 3600),
+	DEF_OPT_INT32("CW_NEG_TTL",       S_CONFIG, cw_neg_ttl,          CW_NEG_TTL_S,    0, 300),
+	DEF_OPT_STR  ("CW_CACHE_SNAPSHOT",S_CONFIG, cw_cache_snapshot,   ""             ),
+	DEF_OPT_STR  ("CW_CACHE_SHM",     S_CONFIG, cw_cache_shm,        ""             ),
 	DEF_OPT_END
 };
 
@@ -207,6 +227,8 @@ static bool parse_ecmkey(const char *v, uint16_t def_caid, S_ECMKEY *out)
 	int i;
 	for (i = 0; i < 16; i++) { unsigned b=0; sscanf(kh+i*2,      "%02X",&b); out->key0[i]=(uint8_t)b; }
 	for (i = 0; i < 16; i++) { unsigned b=0; sscanf(kh+32+i*2,   "%02X",&b); out->key1[i]=(uint8_t)b; }
+	crypt_ede2_setkey(&out->ks0, out->key0);
+	crypt_ede2_setkey(&out->ks1, out->key1);
 	return true;
 }
 
@@ -278,6 +300,7 @@ S_ACCOUNT *cfg_account_new(S_CONFIG *cfg)
 	field_apply_defaults(cfg_account_fields, a);
 	a->caid          = 0x0B00;
 	a->sched_day_from = -1;
+	a->refs          = 1;
 	pthread_mutex_init(&a->stat_mtx, NULL);
 
 	if (!cfg->accounts)
@@ -292,15 +315,62 @@ S_ACCOUNT *cfg_account_new(S_CONFIG *cfg)
 	return a;
 }
 
+void cfg_account_free(S_ACCOUNT *a)
+{
+	pthread_mutex_destroy(&a->stat_mtx);
+	secure_zero(a, sizeof(*a));
+	free(a);
+}
+
+S_ACCOUNT *cfg_account_ref(S_ACCOUNT *a)
+{
+	if (a) atomic_fetch_add(&a->refs, 1);
+	return a;
+}
+
+S_ACCOUNT *cfg_account_acquire(const char *user)
+{
+	pthread_rwlock_rdlock(&g_cfg.acc_lock);
+	S_ACCOUNT *a = cfg_account_ref(cfg_find_account(user));
+	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	return a;
+}
+
+bool cfg_account_admit(S_ACCOUNT **pa)
+{
+	S_ACCOUNT *a = *pa;
+	bool ok = false;
+
+	pthread_rwlock_wrlock(&g_cfg.acc_lock);
+	S_ACCOUNT *cur = cfg_find_account(a->user);
+	if (cur && cur != a)
+	{
+		*pa = cfg_account_ref(cur);
+		cfg_account_release(a);
+		a = cur;
+	}
+	if (cur)
+	{
+		ok = a->max_connections <= 0 || (int32_t)a->active < a->max_connections;
+		if (ok) atomic_fetch_add(&a->active, 1);
+	}
+	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	return ok;
+}
+
+void cfg_account_release(S_ACCOUNT *a)
+{
+	if (a && atomic_fetch_sub(&a->refs, 1) == 1)
+		clients_retire_account(a);
+}
+
 void cfg_accounts_free(S_CONFIG *cfg)
 {
 	S_ACCOUNT *a = cfg->accounts;
 	while (a)
 	{
 		S_ACCOUNT *next = a->next;
-		pthread_mutex_destroy(&a->stat_mtx);
-		secure_zero(a, sizeof(*a));
-		free(a);
+		cfg_account_release(a);
 		a = next;
 	}
 	cfg->accounts  = NULL;
@@ -402,6 +472,7 @@ bool cfg_load(const char *file, S_CONFIG *cfg)
 							{ acc->keys[i] = ek; found = true; break; }
 						if (!found) acc->keys[acc->nkeys++] = ek;
 					}
+					secure_zero(&ek, sizeof(ek));
 				}
 			}
 			break;
@@ -531,9 +602,29 @@ bool cfg_write_default(const char *path)
 	"# NEWCAMD_BINDADDR    =                # Bind address (empty = all interfaces)\n"
 	"CCCAM_PORT            = 12050          # CCcam port (0 = disabled)\n"
 	"SOCKET_TIMEOUT        = 30             # Client socket timeout in seconds (5-600)\n"
+	"MAX_CLIENTS           = 1024           # Concurrent newcamd + CCcam connections; extra connections are refused\n"
+	"IO_THREADS            = 0              # Event loop threads for client connections (0 = one per CPU, restart required)\n"
+	"# IO_BACKEND          = epoll          # Client socket backend: epoll, io_uring (falls back to epoll; restart required)\n"
+	"ACCEPT_THREADS        = 1              # SO_REUSEPORT listeners per port, one pinned accept thread each (0 = one per CPU, restart required)\n"
+	"ECM_WORKERS           = 0              # Threads decoding cache-miss ECMs off the event loop (0 = two per CPU, restart required)\n"
+	"ECM_INFLIGHT          = 8              # Newcamd ECMs decoded concurrently per connection; more are queued\n"
+	"ECM_BUDGET_MS         = 3000           # Queued ECMs not decoded within this time are answered with a NAK\n"
+	"ADMIT_LATENCY_MS      = 2000           # NAK new cache-miss ECMs while average decode latency is above this (0 = off)\n"
+	"ADMIT_QUEUE           = 1024           # NAK new cache-miss ECMs while this many decodes are queued (0 = off)\n"
 	"ECM_LOG               = 1             # Log ECM requests: 1=on 0=off\n"
 	"# LOGFILE             = /var/log/tcmg.log   # Log to file (empty = stdout only; rotates at 10 MB)\n"
 	"# USRFILE             = /var/log/tcmg.usr   # User statistics log (tab-separated; rotates at 5 MB)\n"
+	"# CRYPTO_KERNEL       = auto           # Crypto kernel: auto, generic, generic-avx2build (same C code compiled for avx2/bmi2; restart to apply)\n"
+	"CW_CACHE_ENTRIES      = 4096           # CW cache capacity (rounded up to a power of two sets)\n"
+	"CW_CACHE_WAYS         = 4              # CW cache associativity (1-16)\n"
+	"CW_CACHE_SHARDS       = 16             # CW cache lock stripes (1-256)\n"
+	"CW_CACHE_TTL          = 30             # Default CW cache entry lifetime in seconds (1-3600)\n"
+	"CW_CACHE_TTL_ADAPT    = 1              # Learn the TTL per CAID from observed crypto periods: 1=on 0=off\n"
+	"CW_CACHE_TTL_MIN      = 5              # Lower bound for learned TTLs in seconds\n"
+	"CW_CACHE_TTL_MAX      = 120            # Upper bound for learned TTLs in seconds\n"
+	"CW_NEG_TTL            = 5              # Remember undecodable ECMs per account for N seconds (0 = off)\n"
+	"CW_CACHE_SNAPSHOT     =                # Save live CW cache entries here on shutdown and reload them on start (empty = off)\n"
+	"CW_CACHE_SHM          =                # Share the CW cache with other tcmg processes via this POSIX shm name (empty = private)\n"
 	"\n"
 	"[webif]\n"
 	"ENABLED               = 1             # Enable web interface: 1=on 0=off\n"
@@ -549,7 +640,7 @@ bool cfg_write_default(const char *path)
 	"[account]\n"
 	"user                  = tvcas         # Login username\n"
 	"pwd                   = 1234          # Login password\n"
-	"group                 = 1            # Group number (1-65535)\n"
+	"group                 = 1            # Group number (1-65535); lower groups are decoded first under load\n"
 	"enabled               = 1            # 1=active  0=disabled\n"
 	"fakecw                = 0            # Send fake CW instead of real: 1=on 0=off\n"
 	"caid                  = 0B00,0B01    # Allowed CAIDs (comma-separated hex)\n"
@@ -606,12 +697,17 @@ bool cfg_reload(const char *file, char *errbuf, size_t errsz)
 	ncfg.webif_port     = g_cfg.webif_port;
 	tcmg_strlcpy(ncfg.webif_bindaddr, g_cfg.webif_bindaddr, MAXIPLEN);
 
+	pthread_rwlock_wrlock(&g_cfg.acc_lock);
+
 	for (S_ACCOUNT *na = ncfg.accounts; na; na = na->next) {
 		for (S_ACCOUNT *oa = g_cfg.accounts; oa; oa = oa->next) {
 			if (strcmp(na->user, oa->user) != 0) continue;
 			pthread_mutex_lock(&oa->stat_mtx);
 			na->cw_found         = oa->cw_found;
 			na->cw_not           = oa->cw_not;
+			na->cw_neg           = oa->cw_neg;
+			na->cw_l1_hit        = oa->cw_l1_hit;
+			na->cw_l2_hit        = oa->cw_l2_hit;
 			na->ecm_total        = oa->ecm_total;
 			na->cw_time_total_ms = oa->cw_time_total_ms;
 			na->cw_time_min_ms   = oa->cw_time_min_ms;
@@ -624,9 +720,6 @@ bool cfg_reload(const char *file, char *errbuf, size_t errsz)
 		}
 	}
 
-	pthread_mutex_lock(&g_clients_mtx);
-	pthread_rwlock_wrlock(&g_cfg.acc_lock);
-
 	S_ACCOUNT *old_accounts = g_cfg.accounts;
 	g_cfg.accounts    = ncfg.accounts;  ncfg.accounts  = NULL;
 	g_cfg.naccounts   = ncfg.naccounts;
@@ -637,33 +730,36 @@ bool cfg_reload(const char *file, char *errbuf, size_t errsz)
 	tcmg_strlcpy(g_cfg.newcamd_bindaddr, ncfg.newcamd_bindaddr, MAXIPLEN);
 	g_cfg.cccam_port  = ncfg.cccam_port;
 	g_cfg.sock_timeout= ncfg.sock_timeout;
+	g_cfg.max_clients = ncfg.max_clients;
+	g_cfg.ecm_inflight= ncfg.ecm_inflight;
+	g_cfg.ecm_budget_ms= ncfg.ecm_budget_ms;
+	g_cfg.admit_latency_ms = ncfg.admit_latency_ms;
+	g_cfg.admit_queue      = ncfg.admit_queue;
 	g_cfg.ecm_log     = ncfg.ecm_log;
 	g_cfg.webif_refresh = ncfg.webif_refresh;
+	g_cfg.cw_cache_entries = ncfg.cw_cache_entries;
+	g_cfg.cw_cache_ways    = ncfg.cw_cache_ways;
+	g_cfg.cw_cache_shards  = ncfg.cw_cache_shards;
+	g_cfg.cw_cache_ttl     = ncfg.cw_cache_ttl;
+	g_cfg.cw_cache_ttl_adapt = ncfg.cw_cache_ttl_adapt;
+	g_cfg.cw_cache_ttl_min = ncfg.cw_cache_ttl_min;
+	g_cfg.cw_cache_ttl_max = ncfg.cw_cache_ttl_max;
+	g_cfg.cw_neg_ttl       = ncfg.cw_neg_ttl;
+	tcmg_strlcpy(g_cfg.cw_cache_snapshot, ncfg.cw_cache_snapshot, CFGPATH_LEN);
+	tcmg_strlcpy(g_cfg.cw_cache_shm, ncfg.cw_cache_shm, sizeof(g_cfg.cw_cache_shm));
 	tcmg_strlcpy(g_cfg.logfile,    ncfg.logfile,    CFGPATH_LEN);
 	tcmg_strlcpy(g_cfg.usrfile,    ncfg.usrfile,    CFGPATH_LEN);
 	tcmg_strlcpy(g_cfg.webif_user, ncfg.webif_user, CFGKEY_LEN);
 	tcmg_strlcpy(g_cfg.webif_pass, ncfg.webif_pass, CFGKEY_LEN);
 	tcmg_strlcpy(g_cfg.config_file, file, CFGPATH_LEN);
 
-	for (int _ri = 0; _ri < MAX_ACTIVE_CLIENTS; _ri++) {
-		S_CLIENT *cl = g_clients[_ri];
-		if (!cl || !cl->user[0]) continue;
-		S_ACCOUNT *na;
-		for (na = g_cfg.accounts; na; na = na->next)
-			if (strcmp(cl->user, na->user) == 0) break;
-		cl->account = na;
-		if (!na) cl->kill_flag = 1;
-	}
-
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
-	pthread_mutex_unlock(&g_clients_mtx);
+	atomic_fetch_add(&g_acc_gen, 1);
 
 	S_ACCOUNT *a = old_accounts;
 	while (a) {
 		S_ACCOUNT *next = a->next;
-		pthread_mutex_destroy(&a->stat_mtx);
-		secure_zero(a, sizeof(*a));
-		free(a);
+		cfg_account_release(a);
 		a = next;
 	}
 
@@ -675,6 +771,10 @@ bool cfg_reload(const char *file, char *errbuf, size_t errsz)
 	log_set_file(g_cfg.logfile[0] ? g_cfg.logfile : NULL);
 
 	log_set_usrfile(g_cfg.usrfile[0] ? g_cfg.usrfile : NULL);
+	cw_cache_configure(g_cfg.cw_cache_entries, g_cfg.cw_cache_ways,
+	                   g_cfg.cw_cache_shards,  g_cfg.cw_cache_ttl, g_cfg.cw_cache_shm);
+	auth_cache_flush();
+	cw_neg_flush();
 	tcmg_log("conf reloaded: file=%s accounts=%d", file, g_cfg.naccounts);
 	return true;
 }
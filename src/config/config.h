@@ -29,6 +29,11 @@ bool        cfg_save(S_CONFIG *cfg);
 bool        cfg_reload(const char *file, char *errbuf, size_t errsz);
 S_ACCOUNT  *cfg_find_account(const char *user);
 S_ACCOUNT  *cfg_account_new(S_CONFIG *cfg);
+S_ACCOUNT  *cfg_account_ref(S_ACCOUNT *a);
+S_ACCOUNT  *cfg_account_acquire(const char *user);
+bool        cfg_account_admit(S_ACCOUNT **pa);
+void        cfg_account_release(S_ACCOUNT *a);
+void        cfg_account_free(S_ACCOUNT *a);
 void        cfg_accounts_free(S_CONFIG *cfg);
 bool        cfg_write_default(const char *path);
 void        cfg_print(const S_CONFIG *cfg);
@@ -42,11 +42,14 @@
 #  define SO_CAST(p)   ((const char *)(p))
 #  define RECV_CAST(p) ((char *)(p))
 #  define tcmg_sleep_ms(ms) Sleep((DWORD)(ms))
+   static inline int tcmg_poll_in(int fd, int ms)
+       { WSAPOLLFD p = { (SOCKET)fd, POLLRDNORM, 0 }; return WSAPoll(&p, 1, ms); }
 #else
 #  define TCMG_OS_POSIX 1
 #  include <unistd.h>
 #  include <sys/stat.h>
 #  include <fcntl.h>
+#  include <sys/mman.h>
 #  include <sys/socket.h>
 #  include <sys/time.h>
 #  include <sys/select.h>
@@ -72,6 +75,11 @@ static inline void tcmg_sleep_ms(int ms)
     ts.tv_nsec = (ms % 1000) * 1000000L;
     nanosleep(&ts, NULL);
 }
+static inline int tcmg_poll_in(int fd, int ms)
+{
+    struct pollfd p = { fd, POLLIN, 0 };
+    return poll(&p, 1, ms);
+}
 #endif
 
 #include <pthread.h>
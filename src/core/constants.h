@@ -30,7 +30,24 @@
 #define NC_MSG_MAX           1024
 #define NC_HDR_LEN           8
 #define LOG_RING_MAX         4000
-#define MAX_CONNS            256
+#define MAX_CLIENTS_DEFAULT  1024
+#define MAX_CLIENTS_LIMIT    262144
+#define CONN_RBUF_SIZE       (NC_MSG_MAX + 8)
+#define CONN_WBUF_MAX        65536
+#define CONN_READ_BURST      16
+#define CONN_IBUF_SIZE       8192
+#define IO_THREADS_MAX       64
+#define ACCEPT_THREADS_MAX   16
+#define ACCEPT_BURST         64
+#define ECM_WORKERS_MAX      64
+#define ECM_INFLIGHT_MAX     64
+#define ECM_BACKLOG_MAX      32
+#define ADMIT_PROBE_MS       100
+#define ENGINE_TICK_MS       1000
+#define IO_URING_SQ_ENTRIES  1024
+#define IO_URING_CQ_ENTRIES  8192
+#define IO_URING_BUFS        512
+#define IO_URING_BUF_SIZE    2048
 #define BAN_MAX_FAILS        5
 #define BAN_SECS             300
 #define MAXIPLEN             16
@@ -41,11 +58,39 @@
 #define CFGVAL_LEN           256
 #define CFGPATH_LEN          512
 #define MAX_SID_WHITELIST    64
-#define CW_CACHE_SIZE        512
+#define CW_CACHE_SIZE        4096
+#define CW_CACHE_WAYS        4
+#define CW_CACHE_MAX_WAYS    16
 #define CW_CACHE_SHARDS      16
 #define CW_CACHE_TTL_S       30
-#define MAX_ACTIVE_CLIENTS   256
+#define CW_CACHE_TTL_MIN_S   5
+#define CW_CACHE_TTL_MAX_S   120
+#define CW_CACHE_CAIDS       32
+#define CW_TTL_SIDS          512
+#define CW_TTL_MIN_SAMPLES   3
+#define CW_TTL_MAX_PERIOD_S  600
+#define CW_FLIGHT_SLOTS      64
+#define CW_FLIGHT_WAIT_MS    1000
+#define CW_SRC_EMU           0
+#define CW_SRC_CACHE         1
+#define CW_SRC_COALESCED     2
+#define CW_SRC_NEGATIVE      3
+#define CW_SRC_L1            4
+#define CW_SRC_EXPIRED       5
+#define CW_PROBE_MISS        (-1)
+#define CW_L1_WAYS           4
+#define CW_NEG_CACHE_SIZE    1024
+#define CW_NEG_TTL_S         5
+#define CW_SNAP_MAGIC        "TCMGCWC1"
+#define CW_SHM_MAGIC         0x54434D31u
+#define CW_SHM_ATTACH_MS     2000
+#define CW_SEQ_RETRIES       1000
+#define CW_READER_STRIPES    16
+#define CLIENT_REG_INIT      64
 #define BAN_BUCKETS          256
+#define AUTH_CACHE_SIZE      256
+#define AUTH_CACHE_TTL_S     3600
+#define AUTH_HASH_MAX        64
 #define SRVID_NAME_MAX       80
 
 #define MSG_CLIENT_LOGIN     0xe0
@@ -2,16 +2,82 @@
 #define TCMG_TYPES_H_
 
 typedef struct {
-    uint8_t ecm_md5[16];
-    uint8_t cw[CW_LEN];
-    time_t  ts;
-    int8_t  valid;
+    uint8_t         ecm_md5[16];
+    uint8_t         cw[CW_LEN];
+    time_t          ts;
+    uint16_t        ttl;
+    uint16_t        caid;
+    int8_t          valid;
+    _Atomic uint8_t ref;
 } S_CW_CACHE_ENTRY;
 
+typedef struct {
+    uint8_t  ecm_md5[16];
+    uint8_t  cw[CW_LEN];
+    time_t   expires;
+    uint32_t gen;
+    int8_t   valid;
+} S_CW_L1_ENTRY;
+
+typedef struct {
+    S_CW_L1_ENTRY e[CW_L1_WAYS];
+    uint8_t       hand;
+} S_CW_L1;
+
 typedef struct {
     uint16_t caid;
-    uint8_t  key0[16];
-    uint8_t  key1[16];
+    int32_t  ttl;
+    int32_t  period_s;
+    int32_t  lifetime_s;
+    uint32_t samples;
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t expired;
+    uint64_t evictions;
+    uint64_t lock_wait_us;
+    uint64_t coalesced;
+    uint64_t negative;
+} S_CW_CAID_INFO;
+
+typedef struct {
+    uint64_t locks;
+    uint64_t contended;
+    uint64_t wait_us;
+} S_CW_SHARD_INFO;
+
+typedef struct {
+    uint64_t recv_calls;
+    uint64_t send_calls;
+    uint64_t ring_enters;
+    uint64_t ecm_expired;
+    uint64_t ecm_shed;
+    int32_t  ecm_queued;
+    int32_t  ecm_lat_ms;
+} S_IO_STATS;
+
+typedef struct {
+    uint32_t k[32];
+} S_DES_KS;
+
+typedef struct {
+    S_DES_KS k1;
+    S_DES_KS k2;
+} S_EDE2_KS;
+
+typedef struct {
+    uint8_t keytable[256];
+    uint8_t state;
+    uint8_t counter;
+    uint8_t sum;
+} S_CC_CRYPT;
+
+typedef struct {
+    uint16_t  caid;
+    uint8_t   key0[16];
+    uint8_t   key1[16];
+    S_EDE2_KS ks0;
+    S_EDE2_KS ks1;
 } S_ECMKEY;
 
 typedef struct s_account {
@@ -45,9 +111,14 @@ typedef struct s_account {
     int32_t  nsid_whitelist;
 
     _Atomic int32_t   active;
+    _Atomic int32_t   refs;
+    uint32_t          grace;
     uint64_t          ecm_total;
     int64_t           cw_found;
     int64_t           cw_not;
+    int64_t           cw_neg;
+    int64_t           cw_l1_hit;
+    int64_t           cw_l2_hit;
     int64_t           cw_time_total_ms;
     _Atomic time_t    last_seen;
     time_t            first_login;
@@ -67,9 +138,29 @@ typedef struct s_ban_entry {
 
 typedef struct {
     int32_t  sock_timeout;
+    int32_t  io_threads;
+    char     io_backend[16];
+    int32_t  accept_threads;
+    int32_t  ecm_workers;
+    int32_t  ecm_inflight;
+    int32_t  ecm_budget_ms;
+    int32_t  admit_latency_ms;
+    int32_t  admit_queue;
+    int32_t  max_clients;
     int8_t   ecm_log;
     char     logfile[CFGPATH_LEN];
     char     usrfile[CFGPATH_LEN];
+    char     crypto_kernel[24];
+    int32_t  cw_cache_entries;
+    int32_t  cw_cache_ways;
+    int32_t  cw_cache_shards;
+    int32_t  cw_cache_ttl;
+    int8_t   cw_cache_ttl_adapt;
+    int32_t  cw_cache_ttl_min;
+    int32_t  cw_cache_ttl_max;
+    int32_t  cw_neg_ttl;
+    char     cw_cache_snapshot[CFGPATH_LEN];
+    char     cw_cache_shm[64];
 
     int8_t   webif_enabled;
     int32_t  webif_port;
@@ -94,7 +185,10 @@ typedef struct {
     pthread_mutex_t  ban_lock;
 } S_CONFIG;
 
-typedef struct {
+typedef struct s_conn S_CONN;
+typedef struct s_job  S_JOB;
+
+typedef struct s_client {
     int         fd;
     char        ip[MAXIPLEN];
     uint16_t    caid;
@@ -104,18 +198,21 @@ typedef struct {
     uint32_t    thread_id;
     char        user[CFGKEY_LEN];
     char        client_name[32];
-    uint8_t     key1[16];
-    uint8_t     key2[16];
+    S_EDE2_KS   ks;
     uint8_t     session_key[14];
-    uint8_t     recv_buf[NC_MSG_MAX];
     uint8_t     send_buf[NC_MSG_MAX + 64];
+    S_CONN     *conn;
     S_ACCOUNT  *account;
+    uint32_t    acc_gen;
     uint16_t    last_caid;
     uint16_t    last_srvid;
     char        last_channel[80];
     time_t      connect_time;
     _Atomic time_t  last_ecm_time;
     _Atomic int8_t  kill_flag;
+    int32_t         slot;
+    struct s_client *id_next;
+    struct s_client *user_next;
 } S_CLIENT;
 
 typedef struct {
@@ -125,12 +222,59 @@ typedef struct {
     uint16_t  caid;
     uint32_t  thread_id;
     S_ACCOUNT *account;
+    S_CW_L1   *l1;
 } S_ECM_CTX;
 
 typedef struct {
-    int  fd;
-    char ip[MAXIPLEN];
-} S_CONN_ARGS;
+    const char *name;
+    size_t      size;
+    int32_t   (*on_open)(S_CONN *c);
+    int32_t   (*on_data)(S_CONN *c);
+    int32_t   (*on_tick)(S_CONN *c);
+    void      (*on_close)(S_CONN *c, bool peer);
+    int8_t      ordered;
+} S_CONN_OPS;
+
+struct s_conn {
+    S_CLIENT          cl;
+    const S_CONN_OPS *ops;
+    int32_t           loop;
+    uint8_t           rbuf[CONN_RBUF_SIZE];
+    uint32_t          rlen;
+    uint32_t          want;
+    uint8_t          *wbuf;
+    uint32_t          woff;
+    uint32_t          wlen;
+    uint32_t          wcap;
+    uint8_t          *wold;
+    int8_t            wpoll;
+    int8_t            closing;
+    uint8_t           inflight;
+    int8_t            dirty;
+    int8_t            dead;
+    int64_t           last_rx_ms;
+    uint32_t          grace;
+    struct s_conn    *prev;
+    struct s_conn    *next;
+    struct s_conn    *wnext;
+    uint16_t          jobs;
+    uint16_t          nbacklog;
+    S_JOB            *backlog;
+    S_JOB            *backlog_tail;
+    S_CW_L1           l1;
+};
+
+struct s_job {
+    S_CONN    *conn;
+    S_ACCOUNT *account;
+    size_t     size;
+    void     (*run)(S_JOB *j);
+    void     (*done)(S_JOB *j);
+    S_JOB     *next;
+    int64_t    deadline_ms;
+    int32_t    prio;
+    int8_t     expired;
+};
 
 typedef struct {
     uint16_t    mask;
@@ -1,6 +1,7 @@
 
 #define MODULE_LOG_PREFIX "crypto"
 #include "../../globals.h"
+#include "des_tables.h"
 
 #ifdef TCMG_OS_WINDOWS
 #  include <bcrypt.h>
@@ -12,7 +13,7 @@
 #  endif
 #endif
 
-bool csprng(uint8_t *buf, size_t len)
+static bool os_random(uint8_t *buf, size_t len)
 {
 #ifdef TCMG_OS_WINDOWS
 	NTSTATUS st = BCryptGenRandom(NULL, (PUCHAR)buf, (ULONG)len,
@@ -32,6 +33,129 @@ bool csprng(uint8_t *buf, size_t len)
 #endif
 }
 
+#define DRBG_BLOCKS      8
+#define DRBG_BUFSZ       (DRBG_BLOCKS * 64)
+#define DRBG_RESEED      (1u << 20)
+
+typedef struct {
+	uint32_t key[8];
+	uint64_t ctr;
+	uint8_t  buf[DRBG_BUFSZ];
+	size_t   avail;
+	uint32_t since_reseed;
+	uint32_t fork_gen;
+	bool     seeded;
+} S_DRBG;
+
+static __thread S_DRBG s_drbg;
+static _Atomic uint32_t s_drbg_fork_gen = 0;
+
+#ifndef TCMG_OS_WINDOWS
+static pthread_once_t s_drbg_once = PTHREAD_ONCE_INIT;
+static void drbg_atfork_child(void) { s_drbg_fork_gen++; }
+static void drbg_register_atfork(void) { pthread_atfork(NULL, NULL, drbg_atfork_child); }
+#endif
+
+#define CC20_QR(a, b, c, d) \
+	a += b; d ^= a; d = (d << 16) | (d >> 16); \
+	c += d; b ^= c; b = (b << 12) | (b >> 20); \
+	a += b; d ^= a; d = (d <<  8) | (d >> 24); \
+	c += d; b ^= c; b = (b <<  7) | (b >> 25)
+
+static void chacha20_block(const uint32_t key[8], const uint32_t ctr_nonce[4], uint8_t out[64],
+                           uint32_t in[16], uint32_t x[16])
+{
+	int i;
+	in[0] = 0x61707865; in[1] = 0x3320646e; in[2] = 0x79622d32; in[3] = 0x6b206574;
+	for (i = 0; i < 8; i++) in[4 + i] = key[i];
+	for (i = 0; i < 4; i++) in[12 + i] = ctr_nonce[i];
+	memcpy(x, in, 16 * sizeof(uint32_t));
+	for (i = 0; i < 10; i++)
+	{
+		CC20_QR(x[0], x[4], x[ 8], x[12]); CC20_QR(x[1], x[5], x[ 9], x[13]);
+		CC20_QR(x[2], x[6], x[10], x[14]); CC20_QR(x[3], x[7], x[11], x[15]);
+		CC20_QR(x[0], x[5], x[10], x[15]); CC20_QR(x[1], x[6], x[11], x[12]);
+		CC20_QR(x[2], x[7], x[ 8], x[13]); CC20_QR(x[3], x[4], x[ 9], x[14]);
+	}
+	for (i = 0; i < 16; i++) wr_le32(out + i * 4, x[i] + in[i]);
+}
+#undef CC20_QR
+
+void crypt_chacha20_block(const uint8_t key[32], uint32_t ctr, const uint8_t nonce[12],
+                          uint8_t out[64])
+{
+	uint32_t k[8], cn[4], in[16], x[16];
+	int i;
+	for (i = 0; i < 8; i++) k[i] = rd_le32(key + i * 4);
+	cn[0] = ctr;
+	for (i = 0; i < 3; i++) cn[1 + i] = rd_le32(nonce + i * 4);
+	chacha20_block(k, cn, out, in, x);
+	secure_zero(k, sizeof(k));
+	secure_zero(x, sizeof(x));
+	secure_zero(in, sizeof(in));
+}
+
+static bool drbg_reseed(S_DRBG *d)
+{
+	uint8_t seed[32];
+	int i;
+	if (!os_random(seed, sizeof(seed))) return false;
+	for (i = 0; i < 8; i++) d->key[i] ^= rd_le32(seed + i * 4);
+	secure_zero(seed, sizeof(seed));
+	secure_zero(d->buf, sizeof(d->buf));
+	d->avail        = 0;
+	d->since_reseed = 0;
+	d->fork_gen     = s_drbg_fork_gen;
+	d->seeded       = true;
+	return true;
+}
+
+static void drbg_refill(S_DRBG *d)
+{
+	uint32_t in[16], x[16], cn[4] = { 0, 0, 0, 0 };
+	int i;
+	for (i = 0; i < DRBG_BLOCKS; i++, d->ctr++)
+	{
+		cn[0] = (uint32_t)d->ctr;
+		cn[1] = (uint32_t)(d->ctr >> 32);
+		chacha20_block(d->key, cn, d->buf + i * 64, in, x);
+	}
+	for (i = 0; i < 8; i++) d->key[i] = rd_le32(d->buf + i * 4);
+	secure_zero(x, sizeof(x));
+	secure_zero(in, sizeof(in));
+	memset(d->buf, 0, 32);
+	d->avail = DRBG_BUFSZ - 32;
+}
+
+bool csprng(uint8_t *buf, size_t len)
+{
+	S_DRBG *d = &s_drbg;
+#ifndef TCMG_OS_WINDOWS
+	pthread_once(&s_drbg_once, drbg_register_atfork);
+#endif
+	if (!d->seeded || d->fork_gen != s_drbg_fork_gen || d->since_reseed >= DRBG_RESEED)
+	{
+		if (!drbg_reseed(d) && (!d->seeded || d->fork_gen != s_drbg_fork_gen))
+			return false;
+		d->since_reseed = 0;
+	}
+	while (len > 0)
+	{
+		size_t n;
+		uint8_t *src;
+		if (d->avail == 0) drbg_refill(d);
+		n   = len < d->avail ? len : d->avail;
+		src = d->buf + DRBG_BUFSZ - d->avail;
+		memcpy(buf, src, n);
+		memset(src, 0, n);
+		d->avail -= n;
+		buf      += n;
+		len      -= n;
+		d->since_reseed += (uint32_t)n;
+	}
+	return true;
+}
+
 bool ct_memeq(const uint8_t *a, const uint8_t *b, size_t n)
 {
 	uint8_t diff = 0;
@@ -157,7 +281,7 @@ static uint32_t des_f(uint32_t r, uint64_t sk)
 	}
 	return des_permute32(out, P, 32);
 }
-static void des_block(const uint8_t *in, uint8_t *out, const uint8_t *key, bool dec)
+static void des_block_ref(const uint8_t *in, uint8_t *out, const uint8_t *key, bool dec)
 {
 	uint64_t sk[16];
 	des_subkeys(key, sk);
@@ -177,15 +301,178 @@ static void des_block(const uint8_t *in, uint8_t *out, const uint8_t *key, bool
 	secure_zero(sk, sizeof(sk));
 }
 
-void crypt_init(void) {  }
+#define CRYPT_INLINE static inline __attribute__((always_inline))
+
+#define DES_ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define DES_SWAPMOVE(a, b, n, m) \
+	do { uint32_t t_ = (((a) >> (n)) ^ (b)) & (m); (b) ^= t_; (a) ^= t_ << (n); } while (0)
+
+CRYPT_INLINE void des_ip(uint32_t *l, uint32_t *r)
+{
+	DES_SWAPMOVE(*l, *r,  4, 0x0F0F0F0FU);
+	DES_SWAPMOVE(*l, *r, 16, 0x0000FFFFU);
+	DES_SWAPMOVE(*r, *l,  2, 0x33333333U);
+	DES_SWAPMOVE(*r, *l,  8, 0x00FF00FFU);
+	DES_SWAPMOVE(*l, *r,  1, 0x55555555U);
+}
+
+CRYPT_INLINE void des_fp(uint32_t *l, uint32_t *r)
+{
+	DES_SWAPMOVE(*l, *r,  1, 0x55555555U);
+	DES_SWAPMOVE(*r, *l,  8, 0x00FF00FFU);
+	DES_SWAPMOVE(*r, *l,  2, 0x33333333U);
+	DES_SWAPMOVE(*l, *r, 16, 0x0000FFFFU);
+	DES_SWAPMOVE(*l, *r,  4, 0x0F0F0F0FU);
+}
+
+CRYPT_INLINE uint32_t des_sp_f(uint32_t r, const uint32_t *rk)
+{
+	uint32_t x = DES_ROR(r, 27) ^ rk[0];
+	uint32_t y = DES_ROR(r, 23) ^ rk[1];
+	return DES_SP[0][ x        & 0x3F] | DES_SP[2][(x >> 24) & 0x3F] |
+	       DES_SP[4][(x >> 16) & 0x3F] | DES_SP[6][(x >>  8) & 0x3F] |
+	       DES_SP[1][ y        & 0x3F] | DES_SP[3][(y >> 24) & 0x3F] |
+	       DES_SP[5][(y >> 16) & 0x3F] | DES_SP[7][(y >>  8) & 0x3F];
+}
+
+CRYPT_INLINE void des_rounds(uint32_t *pl, uint32_t *pr, const uint32_t *k, bool dec)
+{
+	uint32_t l = *pl, r = *pr;
+	const uint32_t *rk = dec ? k + 30 : k;
+	int step = dec ? -2 : 2, i;
+	for (i = 0; i < 16; i += 2)
+	{
+		l ^= des_sp_f(r, rk); rk += step;
+		r ^= des_sp_f(l, rk); rk += step;
+	}
+	*pl = r;
+	*pr = l;
+}
+
+static void des_setkey_tab(const uint8_t *key, uint32_t k[32])
+{
+	uint64_t key64 = ((uint64_t)be32(key) << 32) | be32(key + 4);
+	uint64_t perm  = 0, w;
+	uint32_t c, d;
+	int i, j;
+
+	for (i = 0; i < 16; i++)
+		perm |= DES_PC1[i][(key64 >> (60 - i * 4)) & 0x0F];
+	c = (uint32_t)(perm >> 28) & 0x0FFFFFFF;
+	d = (uint32_t)perm & 0x0FFFFFFF;
+	for (i = 0; i < 16; i++)
+	{
+		c = ((c << SH[i]) | (c >> (28 - SH[i]))) & 0x0FFFFFFF;
+		d = ((d << SH[i]) | (d >> (28 - SH[i]))) & 0x0FFFFFFF;
+		uint64_t cd = ((uint64_t)c << 28) | d;
+		w = 0;
+		for (j = 0; j < 14; j++)
+			w |= DES_PC2[j][(cd >> (52 - j * 4)) & 0x0F];
+		k[i * 2]     = (uint32_t)(w >> 32);
+		k[i * 2 + 1] = (uint32_t)w;
+	}
+}
+
+CRYPT_INLINE void des_block_ks(const uint8_t *in, uint8_t *out, const S_DES_KS *ks, bool dec)
+{
+	uint32_t l = be32(in), r = be32(in + 4);
+	des_ip(&l, &r);
+	des_rounds(&l, &r, ks->k, dec);
+	des_fp(&l, &r);
+	wr_be32(out, l);
+	wr_be32(out + 4, r);
+}
+
+CRYPT_INLINE void ede2_block(const S_EDE2_KS *ks, uint32_t *l, uint32_t *r, bool dec)
+{
+	des_ip(l, r);
+	des_rounds(l, r, ks->k1.k,  dec);
+	des_rounds(l, r, ks->k2.k, !dec);
+	des_rounds(l, r, ks->k1.k,  dec);
+	des_fp(l, r);
+}
+
+#define EDE2_LANES 4
+
+CRYPT_INLINE void des_rounds_x4(uint32_t *l, uint32_t *r, const uint32_t *k, bool dec)
+{
+	uint32_t l0 = l[0], l1 = l[1], l2 = l[2], l3 = l[3];
+	uint32_t r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3];
+	const uint32_t *rk = dec ? k + 30 : k;
+	int step = dec ? -2 : 2, i;
+	for (i = 0; i < 16; i += 2)
+	{
+		l0 ^= des_sp_f(r0, rk); l1 ^= des_sp_f(r1, rk);
+		l2 ^= des_sp_f(r2, rk); l3 ^= des_sp_f(r3, rk);
+		rk += step;
+		r0 ^= des_sp_f(l0, rk); r1 ^= des_sp_f(l1, rk);
+		r2 ^= des_sp_f(l2, rk); r3 ^= des_sp_f(l3, rk);
+		rk += step;
+	}
+	l[0] = r0; l[1] = r1; l[2] = r2; l[3] = r3;
+	r[0] = l0; r[1] = l1; r[2] = l2; r[3] = l3;
+}
+
+CRYPT_INLINE void ede2_blocks(const S_EDE2_KS *ks, uint32_t *l, uint32_t *r, size_t n, bool dec)
+{
+	size_t i, j;
+	for (i = 0; i + EDE2_LANES <= n; i += EDE2_LANES)
+	{
+		for (j = 0; j < EDE2_LANES; j++) des_ip(&l[i + j], &r[i + j]);
+		des_rounds_x4(l + i, r + i, ks->k1.k,  dec);
+		des_rounds_x4(l + i, r + i, ks->k2.k, !dec);
+		des_rounds_x4(l + i, r + i, ks->k1.k,  dec);
+		for (j = 0; j < EDE2_LANES; j++) des_fp(&l[i + j], &r[i + j]);
+	}
+	for (; i < n; i++)
+		ede2_block(ks, &l[i], &r[i], dec);
+}
+
+typedef struct {
+	const char *name;
+	void (*des_block)(const uint8_t *in, uint8_t *out, const S_DES_KS *ks, bool dec);
+	void (*ede2_block)(const S_EDE2_KS *ks, uint32_t *l, uint32_t *r, bool dec);
+	void (*ede2_blocks)(const S_EDE2_KS *ks, uint32_t *l, uint32_t *r, size_t n, bool dec);
+	void (*md5_transform)(uint32_t st[4], const uint8_t blk[64]);
+} S_CRYPT_KERN;
+
+static const S_CRYPT_KERN  s_kern_generic;
+static const S_CRYPT_KERN *s_kern = &s_kern_generic;
+static char                s_kern_force[24];
+
+void crypt_des_setkey(S_DES_KS *ks, const uint8_t *key8)
+{
+	des_setkey_tab(key8, ks->k);
+}
+
+void crypt_ede2_setkey(S_EDE2_KS *ks, const uint8_t *key16)
+{
+	des_setkey_tab(key16,     ks->k1.k);
+	des_setkey_tab(key16 + 8, ks->k2.k);
+}
 
 void crypt_des_enc(const uint8_t *key8, const uint8_t *in8, uint8_t *out8)
 {
-	des_block(in8, out8, key8, false);
+	S_DES_KS ks;
+	crypt_des_setkey(&ks, key8);
+	s_kern->des_block(in8, out8, &ks, false);
+	secure_zero(&ks, sizeof(ks));
 }
 void crypt_des_dec(const uint8_t *key8, const uint8_t *in8, uint8_t *out8)
 {
-	des_block(in8, out8, key8, true);
+	S_DES_KS ks;
+	crypt_des_setkey(&ks, key8);
+	s_kern->des_block(in8, out8, &ks, true);
+	secure_zero(&ks, sizeof(ks));
+}
+
+void crypt_des_ref_enc(const uint8_t *key8, const uint8_t *in8, uint8_t *out8)
+{
+	des_block_ref(in8, out8, key8, false);
+}
+void crypt_des_ref_dec(const uint8_t *key8, const uint8_t *in8, uint8_t *out8)
+{
+	des_block_ref(in8, out8, key8, true);
 }
 
 void crypt_des_key_parity_adjust(uint8_t *key, int len)
@@ -220,61 +507,93 @@ void crypt_key_spread(const uint8_t *k, uint8_t *s)
 		crypt_des_key_parity_adjust(s, 16);
 }
 
-void crypt_ede2_cbc(const uint8_t *k16, const uint8_t *iv,
-                     const uint8_t *in, uint8_t *out,
-                     size_t len, bool encrypt)
+void crypt_ede2_cbc_ks(const S_EDE2_KS *ks, const uint8_t *iv,
+                       const uint8_t *in, uint8_t *out,
+                       size_t len, bool encrypt)
 {
-	uint8_t ivec[8], tmp[8];
-	size_t i; int j;
-	memcpy(ivec, iv, 8);
+	uint32_t vl = be32(iv), vr = be32(iv + 4), l, r;
+	size_t i;
 	if (encrypt)
 	{
-		for (i = 0; i < len; i += 8)
+		for (i = 0; i + 8 <= len; i += 8)
 		{
-			for (j = 0; j < 8; j++) out[i+j] = in[i+j] ^ ivec[j];
-			crypt_des_enc(k16,     out+i, out+i);
-			crypt_des_dec(k16+8,   out+i, out+i);
-			crypt_des_enc(k16,     out+i, out+i);
-			memcpy(ivec, out+i, 8);
+			l = be32(in + i)     ^ vl;
+			r = be32(in + i + 4) ^ vr;
+			s_kern->ede2_block(ks, &l, &r, false);
+			wr_be32(out + i, l);
+			wr_be32(out + i + 4, r);
+			vl = l; vr = r;
 		}
 	}
 	else
 	{
-		for (i = 0; i < len; i += 8)
+		uint32_t cl[EDE2_LANES], cr[EDE2_LANES];
+		uint32_t bl[EDE2_LANES], br[EDE2_LANES];
+		size_t n, j;
+		for (i = 0; i + 8 <= len; i += n * 8)
 		{
-			memcpy(tmp, in+i, 8);
-			crypt_des_dec(k16,   in+i, out+i);
-			crypt_des_enc(k16+8, out+i, out+i);
-			crypt_des_dec(k16,   out+i, out+i);
-			for (j = 0; j < 8; j++) out[i+j] ^= ivec[j];
-			memcpy(ivec, tmp, 8);
-			secure_zero(tmp, 8);
+			n = (len - i) / 8;
+			if (n > EDE2_LANES) n = EDE2_LANES;
+			for (j = 0; j < n; j++)
+			{
+				bl[j] = cl[j] = be32(in + i + j * 8);
+				br[j] = cr[j] = be32(in + i + j * 8 + 4);
+			}
+			s_kern->ede2_blocks(ks, bl, br, n, true);
+			for (j = 0; j < n; j++)
+			{
+				wr_be32(out + i + j * 8,     bl[j] ^ vl);
+				wr_be32(out + i + j * 8 + 4, br[j] ^ vr);
+				vl = cl[j]; vr = cr[j];
+			}
 		}
+		secure_zero(bl, sizeof(bl));
+		secure_zero(br, sizeof(br));
 	}
-	secure_zero(ivec, sizeof(ivec));
 }
 
-void crypt_ede2_ecb(const uint8_t *k16, const uint8_t *in, uint8_t *out,
-                    size_t len, bool encrypt)
+void crypt_ede2_ecb_ks(const S_EDE2_KS *ks, const uint8_t *in, uint8_t *out,
+                       size_t len, bool encrypt)
 {
-	size_t i;
-	uint8_t tmp[8];
-	for (i = 0; i < len; i += 8)
+	uint32_t l[EDE2_LANES], r[EDE2_LANES];
+	size_t i, n, j;
+	for (i = 0; i + 8 <= len; i += n * 8)
 	{
-		if (encrypt)
+		n = (len - i) / 8;
+		if (n > EDE2_LANES) n = EDE2_LANES;
+		for (j = 0; j < n; j++)
 		{
-			crypt_des_enc(k16,     in+i, tmp);
-			crypt_des_dec(k16+8,   tmp,  tmp);
-			crypt_des_enc(k16,     tmp,  out+i);
+			l[j] = be32(in + i + j * 8);
+			r[j] = be32(in + i + j * 8 + 4);
 		}
-		else
+		s_kern->ede2_blocks(ks, l, r, n, !encrypt);
+		for (j = 0; j < n; j++)
 		{
-			crypt_des_dec(k16,     in+i, tmp);
-			crypt_des_enc(k16+8,   tmp,  tmp);
-			crypt_des_dec(k16,     tmp,  out+i);
+			wr_be32(out + i + j * 8,     l[j]);
+			wr_be32(out + i + j * 8 + 4, r[j]);
 		}
-		secure_zero(tmp, 8);
 	}
+	secure_zero(l, sizeof(l));
+	secure_zero(r, sizeof(r));
+}
+
+void crypt_ede2_cbc(const uint8_t *k16, const uint8_t *iv,
+                     const uint8_t *in, uint8_t *out,
+                     size_t len, bool encrypt)
+{
+	S_EDE2_KS ks;
+	crypt_ede2_setkey(&ks, k16);
+	crypt_ede2_cbc_ks(&ks, iv, in, out, len, encrypt);
+	secure_zero(&ks, sizeof(ks));
+}
+
+void crypt_ede2_ecb(const uint8_t *k16, const uint8_t *in, uint8_t *out,
+                    size_t len, bool encrypt)
+{
+	S_EDE2_KS ks;
+	crypt_ede2_setkey(&ks, k16);
+	crypt_ede2_ecb_ks(&ks, in, out, len, encrypt);
+	secure_zero(&ks, sizeof(ks));
 }
 
 #define F(x,y,z) (((x)&(y))|((~x)&(z)))
@@ -283,7 +602,7 @@ void crypt_ede2_ecb(const uint8_t *k16, const uint8_t *in, uint8_t *out,
 #define I(x,y,z) ((y)^((x)|(~z)))
 #define ROL(x,n) (((x)<<(n))|((x)>>(32-(n))))
 
-static void md5_transform(uint32_t st[4], const uint8_t blk[64])
+CRYPT_INLINE void md5_transform(uint32_t st[4], const uint8_t blk[64])
 {
 	static const uint32_t T[64] = {
 		0xd76aa478,0xe8c7b756,0x242070db,0xc1bdceee,0xf57c0faf,0x4787c62a,0xa8304613,0xfd469501,
@@ -324,21 +643,115 @@ static void md5_transform(uint32_t st[4], const uint8_t blk[64])
 #undef I
 #undef ROL
 
+#define CRYPT_KERN_DEFINE(sfx, name, attr) \
+	static attr void des_block_##sfx(const uint8_t *in, uint8_t *out, const S_DES_KS *ks, bool dec) \
+	{ des_block_ks(in, out, ks, dec); } \
+	static attr void ede2_block_##sfx(const S_EDE2_KS *ks, uint32_t *l, uint32_t *r, bool dec) \
+	{ ede2_block(ks, l, r, dec); } \
+	static attr void ede2_blocks_##sfx(const S_EDE2_KS *ks, uint32_t *l, uint32_t *r, size_t n, bool dec) \
+	{ ede2_blocks(ks, l, r, n, dec); } \
+	static attr void md5_transform_##sfx(uint32_t st[4], const uint8_t blk[64]) \
+	{ md5_transform(st, blk); } \
+	static const S_CRYPT_KERN s_kern_##sfx = { \
+		name, des_block_##sfx, ede2_block_##sfx, ede2_blocks_##sfx, md5_transform_##sfx }
+
+CRYPT_KERN_DEFINE(generic, "generic", );
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define CRYPT_X86 1
+CRYPT_KERN_DEFINE(avx2build, "generic-avx2build", __attribute__((target("avx2,bmi2"))));
+#elif defined(__arm__) && defined(__linux__)
+#  include <sys/auxv.h>
+#  define CRYPT_HWCAP_NEON (1UL << 12)
+#endif
+
+typedef struct {
+	bool sse2, ssse3, avx2, bmi2, avx512f, neon;
+} S_CPU_FEATURES;
+
+static void cpu_probe(S_CPU_FEATURES *f)
+{
+	memset(f, 0, sizeof(*f));
+#if defined(CRYPT_X86)
+	__builtin_cpu_init();
+	f->sse2    = __builtin_cpu_supports("sse2");
+	f->ssse3   = __builtin_cpu_supports("ssse3");
+	f->avx2    = __builtin_cpu_supports("avx2");
+	f->bmi2    = __builtin_cpu_supports("bmi2");
+	f->avx512f = __builtin_cpu_supports("avx512f");
+#elif defined(__aarch64__)
+	f->neon    = true;
+#elif defined(__arm__) && defined(__linux__)
+	f->neon    = (getauxval(AT_HWCAP) & CRYPT_HWCAP_NEON) != 0;
+#endif
+}
+
+static const S_CRYPT_KERN *kern_by_name(const char *name, const S_CPU_FEATURES *f)
+{
+	if (strcmp(name, "generic") == 0)
+		return &s_kern_generic;
+#if defined(CRYPT_X86)
+	if (strcmp(name, s_kern_avx2build.name) == 0)
+		return (f->avx2 && f->bmi2) ? &s_kern_avx2build : NULL;
+#endif
+	return NULL;
+}
+
+void crypt_force_kernel(const char *name)
+{
+	tcmg_strlcpy(s_kern_force, name ? name : "", sizeof(s_kern_force));
+}
+
+const char *crypt_kernel_name(void)
+{
+	return s_kern->name;
+}
+
+void crypt_init(void)
+{
+	S_CPU_FEATURES f;
+	const S_CRYPT_KERN *k = NULL;
+	const char *want = s_kern_force[0] ? s_kern_force : g_cfg.crypto_kernel;
+
+	cpu_probe(&f);
+	if (want[0] && strcmp(want, "auto") != 0)
+	{
+		k = kern_by_name(want, &f);
+		if (!k)
+			tcmg_log("crypto kernel '%s' not available on this cpu -- using auto", want);
+	}
+	if (!k)
+	{
+#if defined(CRYPT_X86)
+		k = (f.avx2 && f.bmi2) ? &s_kern_avx2build : &s_kern_generic;
+#else
+		k = &s_kern_generic;
+#endif
+	}
+	s_kern = k;
+
+	tcmg_log("cpu sse2=%d ssse3=%d avx2=%d bmi2=%d avx512f=%d neon=%d",
+	         f.sse2, f.ssse3, f.avx2, f.bmi2, f.avx512f, f.neon);
+	tcmg_log("crypto kernels des=%s md5=%s sha1=%s cc=generic%s",
+	         k->name, k->name, sha1_select(k != &s_kern_generic),
+	         k != &s_kern_generic ? " (portable C compiled for avx2/bmi2, no hand-written SIMD)" : "");
+}
+
 void crypt_md5_hash(const uint8_t *data, size_t len, uint8_t out[16])
 {
 	uint32_t st[4] = {0x67452301,0xefcdab89,0x98badcfe,0x10325476};
 	uint8_t  buf[64];
 	size_t   i = 0, rem;
 	int      j;
-	while (i + 64 <= len) { md5_transform(st, data + i); i += 64; }
+	while (i + 64 <= len) { s_kern->md5_transform(st, data + i); i += 64; }
 	rem = len - i;
 	memcpy(buf, data + i, rem);
 	buf[rem] = 0x80;
 	memset(buf + rem + 1, 0, 64 - rem - 1);
-	if (rem >= 56) { md5_transform(st, buf); memset(buf, 0, 64); }
+	if (rem >= 56) { s_kern->md5_transform(st, buf); memset(buf, 0, 64); }
 	uint64_t bits = (uint64_t)len * 8;
 	for (j = 0; j < 8; j++) buf[56 + j] = (uint8_t)((bits >> (j * 8)) & 0xFF);
-	md5_transform(st, buf);
+	s_kern->md5_transform(st, buf);
 	for (j = 0; j < 4; j++) wr_le32(out + j * 4, st[j]);
 	secure_zero(buf, sizeof(buf));
 	secure_zero(st,  sizeof(st));
@@ -428,3 +841,37 @@ bool crypt_md5_crypt(const char *pw, const char *salt_in, char *out, size_t outs
 	memcpy(out, result, opos + 1);
 	return true;
 }
+
+void crypt_cc_init(S_CC_CRYPT *b, const uint8_t *key, int klen)
+{
+	uint8_t j=0,tmp; int i;
+	for(i=0;i<256;i++) b->keytable[i]=(uint8_t)i;
+	for(i=0;i<256;i++){
+		j+=key[i%klen]+b->keytable[i];
+		tmp=b->keytable[i];b->keytable[i]=b->keytable[j];b->keytable[j]=tmp;}
+	b->state=key[0];b->counter=0;b->sum=0;
+}
+
+void crypt_cc_decrypt(S_CC_CRYPT *b, uint8_t *data, int len)
+{
+	uint8_t z,tmp; int i;
+	for(i=0;i<len;i++){
+		b->counter++;b->sum+=b->keytable[b->counter];
+		tmp=b->keytable[b->counter];
+		b->keytable[b->counter]=b->keytable[b->sum];b->keytable[b->sum]=tmp;
+		z=data[i];
+		data[i]=z^b->keytable[(b->keytable[b->counter]+b->keytable[b->sum])&0xFF]^b->state;
+		z=data[i];b->state^=z;}
+}
+
+void crypt_cc_encrypt(S_CC_CRYPT *b, uint8_t *data, int len)
+{
+	uint8_t z,tmp; int i;
+	for(i=0;i<len;i++){
+		b->counter++;b->sum+=b->keytable[b->counter];
+		tmp=b->keytable[b->counter];
+		b->keytable[b->counter]=b->keytable[b->sum];b->keytable[b->sum]=tmp;
+		z=data[i];
+		data[i]=z^b->keytable[(b->keytable[b->counter]+b->keytable[b->sum])&0xFF]^b->state;
+		b->state^=z;}
+}
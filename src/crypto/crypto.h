@@ -2,22 +2,38 @@
 #define TCMG_CRYPTO_H_
 
 void crypt_init(void);
+void crypt_force_kernel(const char *name);
+const char *crypt_kernel_name(void);
 void crypt_des_enc(const uint8_t *key8, const uint8_t *in8, uint8_t *out8);
 void crypt_des_dec(const uint8_t *key8, const uint8_t *in8, uint8_t *out8);
+void crypt_des_ref_enc(const uint8_t *key8, const uint8_t *in8, uint8_t *out8);
+void crypt_des_ref_dec(const uint8_t *key8, const uint8_t *in8, uint8_t *out8);
 void crypt_des_key_parity_adjust(uint8_t *key, int len);
 void crypt_key_spread(const uint8_t *key14, uint8_t *out16);
 void crypt_ede2_cbc(const uint8_t *key16, const uint8_t *iv,
                     const uint8_t *in, uint8_t *out, size_t len, bool encrypt);
 void crypt_ede2_ecb(const uint8_t *key16,
                     const uint8_t *in, uint8_t *out, size_t len, bool encrypt);
+void crypt_des_setkey(S_DES_KS *ks, const uint8_t *key8);
+void crypt_ede2_setkey(S_EDE2_KS *ks, const uint8_t *key16);
+void crypt_ede2_cbc_ks(const S_EDE2_KS *ks, const uint8_t *iv,
+                       const uint8_t *in, uint8_t *out, size_t len, bool encrypt);
+void crypt_ede2_ecb_ks(const S_EDE2_KS *ks,
+                       const uint8_t *in, uint8_t *out, size_t len, bool encrypt);
 bool crypt_md5_crypt(const char *pw, const char *salt, char *out, size_t outsz);
 void crypt_md5_hash(const uint8_t *data, size_t len, uint8_t out[16]);
+void crypt_cc_init(S_CC_CRYPT *b, const uint8_t *key, int klen);
+void crypt_cc_encrypt(S_CC_CRYPT *b, uint8_t *data, int len);
+void crypt_cc_decrypt(S_CC_CRYPT *b, uint8_t *data, int len);
+void crypt_chacha20_block(const uint8_t key[32], uint32_t ctr, const uint8_t nonce[12],
+                          uint8_t out[64]);
 
 bool csprng(uint8_t *buf, size_t len);
 bool ct_memeq(const uint8_t *a, const uint8_t *b, size_t n);
 bool ct_streq(const char *a, const char *b);
 void secure_zero(void *ptr, size_t len);
 
+const char *sha1_select(bool fast);
 void sha1_hash(const uint8_t *data, size_t len, uint8_t out[20]);
 
 #endif
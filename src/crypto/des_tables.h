@@ -0,0 +1,295 @@
+#ifndef TCMG_DES_TABLES_H_
+#define TCMG_DES_TABLES_H_
+
+static const uint32_t DES_SP[8][64] = {
+	{
+		0x00808200,0x00000000,0x00008000,0x00808202,0x00808002,0x00008202,
+		0x00000002,0x00008000,0x00000200,0x00808200,0x00808202,0x00000200,
+		0x00800202,0x00808002,0x00800000,0x00000002,0x00000202,0x00800200,
+		0x00800200,0x00008200,0x00008200,0x00808000,0x00808000,0x00800202,
+		0x00008002,0x00800002,0x00800002,0x00008002,0x00000000,0x00000202,
+		0x00008202,0x00800000,0x00008000,0x00808202,0x00000002,0x00808000,
+		0x00808200,0x00800000,0x00800000,0x00000200,0x00808002,0x00008000,
+		0x00008200,0x00800002,0x00000200,0x00000002,0x00800202,0x00008202,
+		0x00808202,0x00008002,0x00808000,0x00800202,0x00800002,0x00000202,
+		0x00008202,0x00808200,0x00000202,0x00800200,0x00800200,0x00000000,
+		0x00008002,0x00008200,0x00000000,0x00808002
+	},
+	{
+		0x40084010,0x40004000,0x00004000,0x00084010,0x00080000,0x00000010,
+		0x40080010,0x40004010,0x40000010,0x40084010,0x40084000,0x40000000,
+		0x40004000,0x00080000,0x00000010,0x40080010,0x00084000,0x00080010,
+		0x40004010,0x00000000,0x40000000,0x00004000,0x00084010,0x40080000,
+		0x00080010,0x40000010,0x00000000,0x00084000,0x00004010,0x40084000,
+		0x40080000,0x00004010,0x00000000,0x00084010,0x40080010,0x00080000,
+		0x40004010,0x40080000,0x40084000,0x00004000,0x40080000,0x40004000,
+		0x00000010,0x40084010,0x00084010,0x00000010,0x00004000,0x40000000,
+		0x00004010,0x40084000,0x00080000,0x40000010,0x00080010,0x40004010,
+		0x40000010,0x00080010,0x00084000,0x00000000,0x40004000,0x00004010,
+		0x40000000,0x40080010,0x40084010,0x00084000
+	},
+	{
+		0x00000104,0x04010100,0x00000000,0x04010004,0x04000100,0x00000000,
+		0x00010104,0x04000100,0x00010004,0x04000004,0x04000004,0x00010000,
+		0x04010104,0x00010004,0x04010000,0x00000104,0x04000000,0x00000004,
+		0x04010100,0x00000100,0x00010100,0x04010000,0x04010004,0x00010104,
+		0x04000104,0x00010100,0x00010000,0x04000104,0x00000004,0x04010104,
+		0x00000100,0x04000000,0x04010100,0x04000000,0x00010004,0x00000104,
+		0x00010000,0x04010100,0x04000100,0x00000000,0x00000100,0x00010004,
+		0x04010104,0x04000100,0x04000004,0x00000100,0x00000000,0x04010004,
+		0x04000104,0x00010000,0x04000000,0x04010104,0x00000004,0x00010104,
+		0x00010100,0x04000004,0x04010000,0x04000104,0x00000104,0x04010000,
+		0x00010104,0x00000004,0x04010004,0x00010100
+	},
+	{
+		0x80401000,0x80001040,0x80001040,0x00000040,0x00401040,0x80400040,
+		0x80400000,0x80001000,0x00000000,0x00401000,0x00401000,0x80401040,
+		0x80000040,0x00000000,0x00400040,0x80400000,0x80000000,0x00001000,
+		0x00400000,0x80401000,0x00000040,0x00400000,0x80001000,0x00001040,
+		0x80400040,0x80000000,0x00001040,0x00400040,0x00001000,0x00401040,
+		0x80401040,0x80000040,0x00400040,0x80400000,0x00401000,0x80401040,
+		0x80000040,0x00000000,0x00000000,0x00401000,0x00001040,0x00400040,
+		0x80400040,0x80000000,0x80401000,0x80001040,0x80001040,0x00000040,
+		0x80401040,0x80000040,0x80000000,0x00001000,0x80400000,0x80001000,
+		0x00401040,0x80400040,0x80001000,0x00001040,0x00400000,0x80401000,
+		0x00000040,0x00400000,0x00001000,0x00401040
+	},
+	{
+		0x00000080,0x01040080,0x01040000,0x21000080,0x00040000,0x00000080,
+		0x20000000,0x01040000,0x20040080,0x00040000,0x01000080,0x20040080,
+		0x21000080,0x21040000,0x00040080,0x20000000,0x01000000,0x20040000,
+		0x20040000,0x00000000,0x20000080,0x21040080,0x21040080,0x01000080,
+		0x21040000,0x20000080,0x00000000,0x21000000,0x01040080,0x01000000,
+		0x21000000,0x00040080,0x00040000,0x21000080,0x00000080,0x01000000,
+		0x20000000,0x01040000,0x21000080,0x20040080,0x01000080,0x20000000,
+		0x21040000,0x01040080,0x20040080,0x00000080,0x01000000,0x21040000,
+		0x21040080,0x00040080,0x21000000,0x21040080,0x01040000,0x00000000,
+		0x20040000,0x21000000,0x00040080,0x01000080,0x20000080,0x00040000,
+		0x00000000,0x20040000,0x01040080,0x20000080
+	},
+	{
+		0x10000008,0x10200000,0x00002000,0x10202008,0x10200000,0x00000008,
+		0x10202008,0x00200000,0x10002000,0x00202008,0x00200000,0x10000008,
+		0x00200008,0x10002000,0x10000000,0x00002008,0x00000000,0x00200008,
+		0x10002008,0x00002000,0x00202000,0x10002008,0x00000008,0x10200008,
+		0x10200008,0x00000000,0x00202008,0x10202000,0x00002008,0x00202000,
+		0x10202000,0x10000000,0x10002000,0x00000008,0x10200008,0x00202000,
+		0x10202008,0x00200000,0x00002008,0x10000008,0x00200000,0x10002000,
+		0x10000000,0x00002008,0x10000008,0x10202008,0x00202000,0x10200000,
+		0x00202008,0x10202000,0x00000000,0x10200008,0x00000008,0x00002000,
+		0x10200000,0x00202008,0x00002000,0x00200008,0x10002008,0x00000000,
+		0x10202000,0x10000000,0x00200008,0x10002008
+	},
+	{
+		0x00100000,0x02100001,0x02000401,0x00000000,0x00000400,0x02000401,
+		0x00100401,0x02100400,0x02100401,0x00100000,0x00000000,0x02000001,
+		0x00000001,0x02000000,0x02100001,0x00000401,0x02000400,0x00100401,
+		0x00100001,0x02000400,0x02000001,0x02100000,0x02100400,0x00100001,
+		0x02100000,0x00000400,0x00000401,0x02100401,0x00100400,0x00000001,
+		0x02000000,0x00100400,0x02000000,0x00100400,0x00100000,0x02000401,
+		0x02000401,0x02100001,0x02100001,0x00000001,0x00100001,0x02000000,
+		0x02000400,0x00100000,0x02100400,0x00000401,0x00100401,0x02100400,
+		0x00000401,0x02000001,0x02100401,0x02100000,0x00100400,0x00000000,
+		0x00000001,0x02100401,0x00000000,0x00100401,0x02100000,0x00000400,
+		0x02000001,0x02000400,0x00000400,0x00100001
+	},
+	{
+		0x08000820,0x00000800,0x00020000,0x08020820,0x08000000,0x08000820,
+		0x00000020,0x08000000,0x00020020,0x08020000,0x08020820,0x00020800,
+		0x08020800,0x00020820,0x00000800,0x00000020,0x08020000,0x08000020,
+		0x08000800,0x00000820,0x00020800,0x00020020,0x08020020,0x08020800,
+		0x00000820,0x00000000,0x00000000,0x08020020,0x08000020,0x08000800,
+		0x00020820,0x00020000,0x00020820,0x00020000,0x08020800,0x00000800,
+		0x00000020,0x08020020,0x00000800,0x00020820,0x08000800,0x00000020,
+		0x08000020,0x08020000,0x08020020,0x08000000,0x00020000,0x08000820,
+		0x00000000,0x08020820,0x00020020,0x08000020,0x08020000,0x08000800,
+		0x08000820,0x00000000,0x08020820,0x00020800,0x00020800,0x00000820,
+		0x00000820,0x00020020,0x08000000,0x08020800
+	}
+};
+static const uint64_t DES_PC1[16][16] = {
+	{
+		0x0000000000000000ULL,0x0000000000000001ULL,0x0000000100000000ULL,0x0000000100000001ULL,
+		0x0000010000000000ULL,0x0000010000000001ULL,0x0000010100000000ULL,0x0000010100000001ULL,
+		0x0001000000000000ULL,0x0001000000000001ULL,0x0001000100000000ULL,0x0001000100000001ULL,
+		0x0001010000000000ULL,0x0001010000000001ULL,0x0001010100000000ULL,0x0001010100000001ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000000100000ULL,0x0000000000100000ULL,
+		0x0000000000001000ULL,0x0000000000001000ULL,0x0000000000101000ULL,0x0000000000101000ULL,
+		0x0000000000000010ULL,0x0000000000000010ULL,0x0000000000100010ULL,0x0000000000100010ULL,
+		0x0000000000001010ULL,0x0000000000001010ULL,0x0000000000101010ULL,0x0000000000101010ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000002ULL,0x0000000200000000ULL,0x0000000200000002ULL,
+		0x0000020000000000ULL,0x0000020000000002ULL,0x0000020200000000ULL,0x0000020200000002ULL,
+		0x0002000000000000ULL,0x0002000000000002ULL,0x0002000200000000ULL,0x0002000200000002ULL,
+		0x0002020000000000ULL,0x0002020000000002ULL,0x0002020200000000ULL,0x0002020200000002ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000000200000ULL,0x0000000000200000ULL,
+		0x0000000000002000ULL,0x0000000000002000ULL,0x0000000000202000ULL,0x0000000000202000ULL,
+		0x0000000000000020ULL,0x0000000000000020ULL,0x0000000000200020ULL,0x0000000000200020ULL,
+		0x0000000000002020ULL,0x0000000000002020ULL,0x0000000000202020ULL,0x0000000000202020ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000004ULL,0x0000000400000000ULL,0x0000000400000004ULL,
+		0x0000040000000000ULL,0x0000040000000004ULL,0x0000040400000000ULL,0x0000040400000004ULL,
+		0x0004000000000000ULL,0x0004000000000004ULL,0x0004000400000000ULL,0x0004000400000004ULL,
+		0x0004040000000000ULL,0x0004040000000004ULL,0x0004040400000000ULL,0x0004040400000004ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000000400000ULL,0x0000000000400000ULL,
+		0x0000000000004000ULL,0x0000000000004000ULL,0x0000000000404000ULL,0x0000000000404000ULL,
+		0x0000000000000040ULL,0x0000000000000040ULL,0x0000000000400040ULL,0x0000000000400040ULL,
+		0x0000000000004040ULL,0x0000000000004040ULL,0x0000000000404040ULL,0x0000000000404040ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000008ULL,0x0000000800000000ULL,0x0000000800000008ULL,
+		0x0000080000000000ULL,0x0000080000000008ULL,0x0000080800000000ULL,0x0000080800000008ULL,
+		0x0008000000000000ULL,0x0008000000000008ULL,0x0008000800000000ULL,0x0008000800000008ULL,
+		0x0008080000000000ULL,0x0008080000000008ULL,0x0008080800000000ULL,0x0008080800000008ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000000800000ULL,0x0000000000800000ULL,
+		0x0000000000008000ULL,0x0000000000008000ULL,0x0000000000808000ULL,0x0000000000808000ULL,
+		0x0000000000000080ULL,0x0000000000000080ULL,0x0000000000800080ULL,0x0000000000800080ULL,
+		0x0000000000008080ULL,0x0000000000008080ULL,0x0000000000808080ULL,0x0000000000808080ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000010000000ULL,0x0000001000000000ULL,0x0000001010000000ULL,
+		0x0000100000000000ULL,0x0000100010000000ULL,0x0000101000000000ULL,0x0000101010000000ULL,
+		0x0010000000000000ULL,0x0010000010000000ULL,0x0010001000000000ULL,0x0010001010000000ULL,
+		0x0010100000000000ULL,0x0010100010000000ULL,0x0010101000000000ULL,0x0010101010000000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000001000000ULL,0x0000000001000000ULL,
+		0x0000000000010000ULL,0x0000000000010000ULL,0x0000000001010000ULL,0x0000000001010000ULL,
+		0x0000000000000100ULL,0x0000000000000100ULL,0x0000000001000100ULL,0x0000000001000100ULL,
+		0x0000000000010100ULL,0x0000000000010100ULL,0x0000000001010100ULL,0x0000000001010100ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000020000000ULL,0x0000002000000000ULL,0x0000002020000000ULL,
+		0x0000200000000000ULL,0x0000200020000000ULL,0x0000202000000000ULL,0x0000202020000000ULL,
+		0x0020000000000000ULL,0x0020000020000000ULL,0x0020002000000000ULL,0x0020002020000000ULL,
+		0x0020200000000000ULL,0x0020200020000000ULL,0x0020202000000000ULL,0x0020202020000000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000002000000ULL,0x0000000002000000ULL,
+		0x0000000000020000ULL,0x0000000000020000ULL,0x0000000002020000ULL,0x0000000002020000ULL,
+		0x0000000000000200ULL,0x0000000000000200ULL,0x0000000002000200ULL,0x0000000002000200ULL,
+		0x0000000000020200ULL,0x0000000000020200ULL,0x0000000002020200ULL,0x0000000002020200ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000040000000ULL,0x0000004000000000ULL,0x0000004040000000ULL,
+		0x0000400000000000ULL,0x0000400040000000ULL,0x0000404000000000ULL,0x0000404040000000ULL,
+		0x0040000000000000ULL,0x0040000040000000ULL,0x0040004000000000ULL,0x0040004040000000ULL,
+		0x0040400000000000ULL,0x0040400040000000ULL,0x0040404000000000ULL,0x0040404040000000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000004000000ULL,0x0000000004000000ULL,
+		0x0000000000040000ULL,0x0000000000040000ULL,0x0000000004040000ULL,0x0000000004040000ULL,
+		0x0000000000000400ULL,0x0000000000000400ULL,0x0000000004000400ULL,0x0000000004000400ULL,
+		0x0000000000040400ULL,0x0000000000040400ULL,0x0000000004040400ULL,0x0000000004040400ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000080000000ULL,0x0000008000000000ULL,0x0000008080000000ULL,
+		0x0000800000000000ULL,0x0000800080000000ULL,0x0000808000000000ULL,0x0000808080000000ULL,
+		0x0080000000000000ULL,0x0080000080000000ULL,0x0080008000000000ULL,0x0080008080000000ULL,
+		0x0080800000000000ULL,0x0080800080000000ULL,0x0080808000000000ULL,0x0080808080000000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000000ULL,0x0000000008000000ULL,0x0000000008000000ULL,
+		0x0000000000080000ULL,0x0000000000080000ULL,0x0000000008080000ULL,0x0000000008080000ULL,
+		0x0000000000000800ULL,0x0000000000000800ULL,0x0000000008000800ULL,0x0000000008000800ULL,
+		0x0000000000080800ULL,0x0000000000080800ULL,0x0000000008080800ULL,0x0000000008080800ULL
+	}
+};
+static const uint64_t DES_PC2[14][16] = {
+	{
+		0x0000000000000000ULL,0x0400000000000000ULL,0x0000000000000020ULL,0x0400000000000020ULL,
+		0x0000000001000000ULL,0x0400000001000000ULL,0x0000000001000020ULL,0x0400000001000020ULL,
+		0x0000000200000000ULL,0x0400000200000000ULL,0x0000000200000020ULL,0x0400000200000020ULL,
+		0x0000000201000000ULL,0x0400000201000000ULL,0x0000000201000020ULL,0x0400000201000020ULL
+	},
+	{
+		0x0000000000000000ULL,0x0100000000000000ULL,0x0000000010000000ULL,0x0100000010000000ULL,
+		0x0000000000000004ULL,0x0100000000000004ULL,0x0000000010000004ULL,0x0100000010000004ULL,
+		0x0000000100000000ULL,0x0100000100000000ULL,0x0000000110000000ULL,0x0100000110000000ULL,
+		0x0000000100000004ULL,0x0100000100000004ULL,0x0000000110000004ULL,0x0100000110000004ULL
+	},
+	{
+		0x0000000000000000ULL,0x0800000000000000ULL,0x0000000800000000ULL,0x0800000800000000ULL,
+		0x0000000000000001ULL,0x0800000000000001ULL,0x0000000800000001ULL,0x0800000800000001ULL,
+		0x0000000000000000ULL,0x0800000000000000ULL,0x0000000800000000ULL,0x0800000800000000ULL,
+		0x0000000000000001ULL,0x0800000000000001ULL,0x0000000800000001ULL,0x0800000800000001ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000020000000ULL,0x0000000000000008ULL,0x0000000020000008ULL,
+		0x0000002000000000ULL,0x0000002020000000ULL,0x0000002000000008ULL,0x0000002020000008ULL,
+		0x0000000002000000ULL,0x0000000022000000ULL,0x0000000002000008ULL,0x0000000022000008ULL,
+		0x0000002002000000ULL,0x0000002022000000ULL,0x0000002002000008ULL,0x0000002022000008ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000004000000ULL,0x1000000000000000ULL,0x1000000004000000ULL,
+		0x0000000000000000ULL,0x0000000004000000ULL,0x1000000000000000ULL,0x1000000004000000ULL,
+		0x0000001000000000ULL,0x0000001004000000ULL,0x1000001000000000ULL,0x1000001004000000ULL,
+		0x0000001000000000ULL,0x0000001004000000ULL,0x1000001000000000ULL,0x1000001004000000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000400000000ULL,0x2000000000000000ULL,0x2000000400000000ULL,
+		0x0000000000000000ULL,0x0000000400000000ULL,0x2000000000000000ULL,0x2000000400000000ULL,
+		0x0000000000000002ULL,0x0000000400000002ULL,0x2000000000000002ULL,0x2000000400000002ULL,
+		0x0000000000000002ULL,0x0000000400000002ULL,0x2000000000000002ULL,0x2000000400000002ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000010ULL,0x0000000008000000ULL,0x0000000008000010ULL,
+		0x0200000000000000ULL,0x0200000000000010ULL,0x0200000008000000ULL,0x0200000008000010ULL,
+		0x0000000000000000ULL,0x0000000000000010ULL,0x0000000008000000ULL,0x0000000008000010ULL,
+		0x0200000000000000ULL,0x0200000000000010ULL,0x0200000008000000ULL,0x0200000008000010ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000100ULL,0x0008000000000000ULL,0x0008000000000100ULL,
+		0x0000000000200000ULL,0x0000000000200100ULL,0x0008000000200000ULL,0x0008000000200100ULL,
+		0x0000000000000200ULL,0x0000000000000300ULL,0x0008000000000200ULL,0x0008000000000300ULL,
+		0x0000000000200200ULL,0x0000000000200300ULL,0x0008000000200200ULL,0x0008000000200300ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000000400ULL,0x0000000000000000ULL,0x0000000000000400ULL,
+		0x0000020000000000ULL,0x0000020000000400ULL,0x0000020000000000ULL,0x0000020000000400ULL,
+		0x0000000000020000ULL,0x0000000000020400ULL,0x0000000000020000ULL,0x0000000000020400ULL,
+		0x0000020000020000ULL,0x0000020000020400ULL,0x0000020000020000ULL,0x0000020000020400ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000100000ULL,0x0000080000000000ULL,0x0000080000100000ULL,
+		0x0000000000000000ULL,0x0000000000100000ULL,0x0000080000000000ULL,0x0000080000100000ULL,
+		0x0004000000000000ULL,0x0004000000100000ULL,0x0004080000000000ULL,0x0004080000100000ULL,
+		0x0004000000000000ULL,0x0004000000100000ULL,0x0004080000000000ULL,0x0004080000100000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000200000000000ULL,0x0000000000000000ULL,0x0000200000000000ULL,
+		0x0000000000001000ULL,0x0000200000001000ULL,0x0000000000001000ULL,0x0000200000001000ULL,
+		0x0020000000000000ULL,0x0020200000000000ULL,0x0020000000000000ULL,0x0020200000000000ULL,
+		0x0020000000001000ULL,0x0020200000001000ULL,0x0020000000001000ULL,0x0020200000001000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000000000010000ULL,0x0002000000000000ULL,0x0002000000010000ULL,
+		0x0000000000002000ULL,0x0000000000012000ULL,0x0002000000002000ULL,0x0002000000012000ULL,
+		0x0000000000040000ULL,0x0000000000050000ULL,0x0002000000040000ULL,0x0002000000050000ULL,
+		0x0000000000042000ULL,0x0000000000052000ULL,0x0002000000042000ULL,0x0002000000052000ULL
+	},
+	{
+		0x0000000000000000ULL,0x0010000000000000ULL,0x0000000000080000ULL,0x0010000000080000ULL,
+		0x0000000000000800ULL,0x0010000000000800ULL,0x0000000000080800ULL,0x0010000000080800ULL,
+		0x0000100000000000ULL,0x0010100000000000ULL,0x0000100000080000ULL,0x0010100000080000ULL,
+		0x0000100000000800ULL,0x0010100000000800ULL,0x0000100000080800ULL,0x0010100000080800ULL
+	},
+	{
+		0x0000000000000000ULL,0x0000040000000000ULL,0x0001000000000000ULL,0x0001040000000000ULL,
+		0x0000000000000000ULL,0x0000040000000000ULL,0x0001000000000000ULL,0x0001040000000000ULL,
+		0x0000010000000000ULL,0x0000050000000000ULL,0x0001010000000000ULL,0x0001050000000000ULL,
+		0x0000010000000000ULL,0x0000050000000000ULL,0x0001010000000000ULL,0x0001050000000000ULL
+	}
+};
+
+#endif
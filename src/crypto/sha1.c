@@ -8,7 +8,7 @@ static void sha1_init(SHA1_CTX *c){
     c->H[0]=0x67452301;c->H[1]=0xEFCDAB89;c->H[2]=0x98BADCFE;
     c->H[3]=0x10325476;c->H[4]=0xC3D2E1F0;c->lo=c->hi=0;memset(c->buf,0,64);}
 
-static void sha1_block(SHA1_CTX *c,const uint8_t *blk){
+static inline __attribute__((always_inline)) void sha1_block_body(SHA1_CTX *c,const uint8_t *blk){
     uint32_t W[80],a,b,cc,d,e,f=0,k=0,t;int i;
     for(i=0;i<16;i++)W[i]=((uint32_t)blk[i*4]<<24)|((uint32_t)blk[i*4+1]<<16)|
                            ((uint32_t)blk[i*4+2]<<8)|(uint32_t)blk[i*4+3];
@@ -22,6 +22,19 @@ static void sha1_block(SHA1_CTX *c,const uint8_t *blk){
         t=SHA1_ROL(a,5)+f+e+k+W[i];e=d;d=cc;cc=SHA1_ROL(b,30);b=a;a=t;}
     c->H[0]+=a;c->H[1]+=b;c->H[2]+=cc;c->H[3]+=d;c->H[4]+=e;}
 
+static void sha1_block_generic(SHA1_CTX *c,const uint8_t *blk){sha1_block_body(c,blk);}
+#if defined(__x86_64__) || defined(__i386__)
+static __attribute__((target("avx2,bmi2"))) void sha1_block_avx2(SHA1_CTX *c,const uint8_t *blk){sha1_block_body(c,blk);}
+#endif
+
+static void (*sha1_block)(SHA1_CTX *c,const uint8_t *blk) = sha1_block_generic;
+
+const char *sha1_select(bool fast){
+#if defined(__x86_64__) || defined(__i386__)
+    if(fast){sha1_block=sha1_block_avx2;return "generic-avx2build";}
+#endif
+    sha1_block=sha1_block_generic;return "generic";}
+
 static void sha1_update(SHA1_CTX *c,const uint8_t *data,size_t len){
     uint32_t idx=c->lo&63;c->lo+=(uint32_t)len;
     if(c->lo<(uint32_t)len) c->hi++;
@@ -29,22 +29,20 @@ static void gen_fake_cw(uint8_t *cw)
     pthread_mutex_unlock(&s_fake_mtx);
 }
 
-static bool key_lookup(const S_ACCOUNT *acc, uint16_t caid,
-                        uint8_t kidx, uint8_t *key_out)
+static const S_EDE2_KS *key_lookup(const S_ACCOUNT *acc, uint16_t caid, uint8_t kidx)
 {
 	int i;
 	for (i = 0; i < acc->nkeys; i++)
 	{
 		if (acc->keys[i].caid == caid)
 		{
-			memcpy(key_out, kidx == 0 ? acc->keys[i].key0 : acc->keys[i].key1, 16);
 			tcmg_log_dbg(D_EMU, "key found for caid=%04X kidx=%u slot=%d", caid, kidx, i);
-			return true;
+			return kidx == 0 ? &acc->keys[i].ks0 : &acc->keys[i].ks1;
 		}
 	}
 	tcmg_log_dbg(D_EMU, "no key for caid=%04X kidx=%u (account has %d key(s))",
 	             caid, kidx, acc->nkeys);
-	return false;
+	return NULL;
 }
 
 static uint8_t csum8(const uint8_t *d, uint8_t len)
@@ -83,8 +81,8 @@ static int32_t tcmg_decode(uint16_t caid, const uint8_t *ecm, int32_t len,
 	}
 	const uint8_t *sdata = ecm + 7;
 
-	uint8_t key[16];
-	if (!key_lookup(acc, caid, kidx, key)) return EMU_KEY_NOT_FOUND;
+	const S_EDE2_KS *ks = key_lookup(acc, caid, kidx);
+	if (!ks) return EMU_KEY_NOT_FOUND;
 
 	uint8_t dec[48];
 	memcpy(dec, sdata, slen);
@@ -92,7 +90,7 @@ static int32_t tcmg_decode(uint16_t caid, const uint8_t *ecm, int32_t len,
 	tcmg_dump_dbg(D_EMU, sdata, slen,
 	              "caid=%04X ENC kidx=%u", caid, kidx);
 
-	crypt_ede2_ecb(key, dec, dec, slen, false);
+	crypt_ede2_ecb_ks(ks, dec, dec, slen, false);
 
 	tcmg_dump_dbg(D_EMU, dec, slen,
 	              "caid=%04X DEC kidx=%u", caid, kidx);
@@ -102,7 +100,6 @@ static int32_t tcmg_decode(uint16_t caid, const uint8_t *ecm, int32_t len,
 	{
 		tcmg_log_dbg(D_EMU, "caid=%04X checksum error: got=0x%02X expected=0x%02X",
 		             caid, dec[slen - 1], expected_csum);
-		secure_zero(key, sizeof(key));
 		secure_zero(dec, sizeof(dec));
 		return EMU_CHECKSUM_ERROR;
 	}
@@ -112,7 +109,6 @@ static int32_t tcmg_decode(uint16_t caid, const uint8_t *ecm, int32_t len,
 
 	tcmg_dump_dbg(D_EMU, cw, CW_LEN,
 	              "caid=%04X CW extracted successfully", caid);
-	secure_zero(key, sizeof(key));
 	secure_zero(dec, sizeof(dec));
 	return EMU_OK;
 }
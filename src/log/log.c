@@ -634,7 +634,7 @@ void log_ecm_raw(uint16_t caid, uint16_t sid, const uint8_t *data, int32_t len)
 }
 
 void log_cw_result(uint16_t caid, uint16_t sid, int32_t len,
-                   const uint8_t *cw, bool hit, bool from_cache,
+                   const uint8_t *cw, bool hit, uint8_t src,
                    int32_t ms, const char *user)
 {
 	char body[512];
@@ -660,7 +660,10 @@ void log_cw_result(uint16_t caid, uint16_t sid, int32_t len,
 			cw_str[32] = '\0';
 		}
 
-		const char *result = hit ? (from_cache ? "cache" : "found") : "not found";
+		const char *result = !hit                    ? "not found" :
+		                     src == CW_SRC_CACHE ||
+		                     src == CW_SRC_L1        ? "cache"     :
+		                     src == CW_SRC_COALESCED ? "coalesced" : "found";
 
 		if (hit) {
 			if (ch)
@@ -675,8 +678,10 @@ void log_cw_result(uint16_t caid, uint16_t sid, int32_t len,
 				         user ? user : "?");
 		} else {
 			snprintf(body, sizeof(body),
-			         "(%04X:%04X:%02X): not found (%d ms)",
-			         caid, sid, (int)len, ms);
+			         "(%04X:%04X:%02X): not found%s (%d ms)",
+			         caid, sid, (int)len,
+			         src == CW_SRC_NEGATIVE ? " (cached)" :
+			         src == CW_SRC_EXPIRED  ? " (deadline)" : "", ms);
 		}
 
 		usr_line[0] = '\0';
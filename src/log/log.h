@@ -49,7 +49,7 @@ int8_t  log_ecm_get(void);
 
 void    log_ecm_raw(uint16_t caid, uint16_t sid, const uint8_t *data, int32_t len);
 void    log_cw_result(uint16_t caid, uint16_t sid, int32_t len,
-                      const uint8_t *cw, bool hit, bool from_cache,
+                      const uint8_t *cw, bool hit, uint8_t src,
                       int32_t ms, const char *user);
 
 int32_t log_ring_since(int32_t from_id, char **out_lines, char **out_users,
@@ -15,6 +15,7 @@ static void print_usage(const char *prog)
 	       "                0x0001=wire    0x0002=ecm     0x0004=emu\n"
 	       "                0x0008=newcamd 0x0010=cccam   0x0020=http\n"
 	       "                0x0040=conn    0xFFFF=all\n"
+	       "  -k <name>   Crypto kernel: auto, generic, generic-avx2build (overrides CRYPTO_KERNEL)\n"
 	       "  -v          Show version and exit\n"
 	       "  -h          Show this help\n\n",
 	       prog, CS_CONFDIR);
@@ -45,6 +46,10 @@ int main(int argc, char *argv[])
 			if (v >= 0 && v <= 0xFFFF)
 				g_dblevel = (uint16_t)v;
 		}
+		else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+		{
+			crypt_force_kernel(argv[++i]);
+		}
 		else if (strcmp(argv[i], "-b") == 0)
 		{
 			do_daemon = 1;
@@ -126,8 +131,13 @@ int main(int argc, char *argv[])
 	}
 
 	log_init();
+	cw_cache_configure(g_cfg.cw_cache_entries, g_cfg.cw_cache_ways,
+	                   g_cfg.cw_cache_shards,  g_cfg.cw_cache_ttl, g_cfg.cw_cache_shm);
+	if (g_cfg.cw_cache_snapshot[0])
+		cw_cache_load(g_cfg.cw_cache_snapshot);
 	emu_init();
 	webif_start();
+	engine_start(g_cfg.io_threads, g_cfg.io_backend, g_cfg.ecm_workers);
 	cccam_start();
 	newcamd_start();
 
@@ -145,6 +155,8 @@ int main(int argc, char *argv[])
 			else
 				tcmg_log("reload: config FAILED reason=%s", errbuf);
 		}
+		clients_reclaim();
+		cw_cache_reclaim();
 		sleep(1);
 	}
 
@@ -159,6 +171,7 @@ int main(int argc, char *argv[])
 	webif_stop();
 	cccam_stop();
 	newcamd_stop();
+	engine_stop();
 
 	for (int w = 0; w < 50 && g_active_conns > 0; w++)
 	{
@@ -173,8 +186,12 @@ int main(int argc, char *argv[])
 	pthread_rwlock_wrlock(&g_cfg.acc_lock);
 	cfg_accounts_free(&g_cfg);
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	clients_reclaim();
 	ban_free_all();
 	srvid_free();
+	if (g_cfg.cw_cache_snapshot[0])
+		cw_cache_save(g_cfg.cw_cache_snapshot);
+	cw_cache_free();
 	pthread_rwlock_destroy(&g_cfg.acc_lock);
 	pthread_mutex_destroy(&g_cfg.ban_lock);
 
@@ -0,0 +1,1366 @@
+#define MODULE_LOG_PREFIX "engine"
+#include "../../globals.h"
+
+#if defined(__linux__)
+#  include <sys/epoll.h>
+#  include <sys/eventfd.h>
+#  define ENGINE_HAVE_EPOLL 1
+#  if !defined(__ANDROID__)
+#    include <sys/syscall.h>
+#    include <linux/io_uring.h>
+#    include <poll.h>
+#    if defined(__NR_io_uring_setup) && defined(IORING_RECV_MULTISHOT)
+#      define ENGINE_HAVE_URING 1
+#    endif
+#  endif
+#endif
+
+static _Atomic uint32_t s_conn_id = 0;
+static _Atomic uint64_t s_io_recv = 0;
+static _Atomic uint64_t s_io_send = 0;
+static _Atomic uint64_t s_io_enter = 0;
+static _Atomic uint64_t s_jobs_expired = 0;
+static _Atomic uint64_t s_ecm_shed = 0;
+static _Atomic int32_t  s_jobq_depth = 0;
+static _Atomic int32_t  s_ecm_lat16 = 0;
+static _Atomic int64_t  s_admit_probe_ms = 0;
+
+static int32_t conn_feed(S_CONN *c, const uint8_t *p, uint32_t n)
+{
+	c->last_rx_ms = tcmg_mono_ms();
+	client_relink_account(&c->cl);
+	while (n)
+	{
+		uint32_t k = c->want - c->rlen;
+		if (k > n) k = n;
+		memcpy(c->rbuf + c->rlen, p, k);
+		c->rlen += k;
+		p       += k;
+		n       -= k;
+		if (c->rlen == c->want && c->ops->on_data(c) < 0)
+			return c->closing ? 0 : -1;
+		if (c->closing) return 0;
+	}
+	return 1;
+}
+
+static int32_t conn_open(S_CONN *c)
+{
+	log_set_user(NULL);
+	if (!client_register(&c->cl))
+	{
+		tcmg_log("%s [%s] cannot register client -- connection rejected", c->cl.ip, c->ops->name);
+		return -1;
+	}
+	net_tune_socket(c->cl.fd);
+	c->last_rx_ms = tcmg_mono_ms();
+	tcmg_log_dbg(D_CONN, "%s [%s] new connection fd=%d id=%u",
+	             c->cl.ip, c->ops->name, c->cl.fd, c->cl.thread_id);
+	return c->ops->on_open(c);
+}
+
+static void conn_retire(S_CONN *c, bool peer)
+{
+	S_CLIENT *cl = &c->cl;
+
+	log_set_user(cl->user);
+	c->ops->on_close(c, peer);
+	client_unregister(cl);
+	c->grace = clients_grace_stamp();
+	client_drop_account(cl);
+
+	tcmg_log_dbg(D_CONN, "%s [%s] connection closed fd=%d id=%u",
+	             cl->ip, c->ops->name, cl->fd, cl->thread_id);
+	close(cl->fd);
+	log_set_user(NULL);
+	atomic_fetch_sub(&g_active_conns, 1);
+}
+
+static void conn_free(S_CONN *c)
+{
+	if (c->wbuf)
+	{
+		secure_zero(c->wbuf, c->wcap);
+		free(c->wbuf);
+	}
+	free(c->wold);
+	cfg_account_release(c->cl.account);
+	secure_zero(c, c->ops->size);
+	free(c);
+}
+
+static void job_free(S_JOB *j)
+{
+	cfg_account_release(j->account);
+	secure_zero(j, j->size);
+	free(j);
+}
+
+static void conn_close(S_CONN *c, bool peer)
+{
+	conn_retire(c, peer);
+	while (!clients_grace_passed(c->grace))
+		tcmg_sleep_ms(1);
+	conn_free(c);
+}
+
+static void *conn_thread(void *arg)
+{
+	S_CONN *c    = (S_CONN *)arg;
+	bool    peer = false;
+	uint8_t buf[CONN_IBUF_SIZE];
+
+	log_set_type(LOG_TYPE_CLIENT);
+	net_set_blocking(c->cl.fd, true);
+	net_set_timeout(c->cl.fd, g_cfg.sock_timeout);
+
+	if (conn_open(c) >= 0)
+	{
+		while (g_running && !c->cl.kill_flag && !c->closing)
+		{
+			client_relink_account(&c->cl);
+			if (c->ops->on_tick(c) < 0) break;
+			ssize_t n = recv(c->cl.fd, RECV_CAST(buf), (int)sizeof(buf), 0);
+			atomic_fetch_add_explicit(&s_io_recv, 1, memory_order_relaxed);
+			if (n <= 0) { peer = true; break; }
+			if (conn_feed(c, buf, (uint32_t)n) < 0) break;
+		}
+		if (c->closing) peer = true;
+	}
+
+	conn_close(c, peer);
+	cw_l1_flush();
+	return NULL;
+}
+
+#ifdef ENGINE_HAVE_EPOLL
+
+#define URING_OP_RECV   1
+#define URING_OP_SEND   2
+#define URING_OP_CANCEL 3
+#define URING_OP_WAKE   4
+#define URING_OP_TICK   5
+#define URING_OP_MASK   7
+#define URING_BGID      1
+
+#ifdef ENGINE_HAVE_URING
+
+typedef struct {
+	int                       fd;
+	uint32_t                 *sq_head;
+	uint32_t                 *sq_tail;
+	uint32_t                 *sq_mask;
+	uint32_t                 *sq_array;
+	uint32_t                  sq_entries;
+	uint32_t                  sq_local;
+	uint32_t                  sq_flushed;
+	struct io_uring_sqe      *sqes;
+	uint32_t                 *cq_head;
+	uint32_t                 *cq_tail;
+	uint32_t                 *cq_mask;
+	struct io_uring_cqe      *cqes;
+	void                     *sq_map;
+	void                     *cq_map;
+	size_t                    sq_map_sz;
+	size_t                    cq_map_sz;
+	size_t                    sqe_map_sz;
+	struct io_uring_buf_ring *br;
+	size_t                    br_sz;
+	uint8_t                  *bufs;
+	uint16_t                  br_tail;
+	int8_t                    single_shot;
+	struct __kernel_timespec  tick;
+	S_CONN                   *dirty;
+} S_URING;
+
+#endif
+
+typedef struct {
+	int              epfd;
+	int              evfd;
+	pthread_t        tid;
+	pthread_mutex_t  mtx;
+	S_CONN          *pending;
+	S_JOB           *done;
+	S_CONN          *head;
+	S_CONN          *dead;
+	_Atomic int32_t  nconns;
+#ifdef ENGINE_HAVE_URING
+	S_URING         *ring;
+#endif
+} S_IO_LOOP;
+
+static S_IO_LOOP       *s_loops  = NULL;
+static int32_t          s_nloops = 0;
+static _Atomic int32_t  s_engine_running = 0;
+
+static pthread_t       *s_workers  = NULL;
+static int32_t          s_nworkers = 0;
+static int8_t           s_workers_running = 0;
+static pthread_mutex_t  s_jobq_mtx  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   s_jobq_cond = PTHREAD_COND_INITIALIZER;
+static S_JOB          **s_jobq      = NULL;
+static int32_t          s_jobq_len  = 0;
+static int32_t          s_jobq_cap  = 0;
+
+static void io_loop_drop(S_IO_LOOP *lp, S_CONN *c, bool peer);
+
+static void io_loop_link(S_IO_LOOP *lp, S_CONN *c)
+{
+	c->prev = NULL;
+	c->next = lp->head;
+	if (lp->head) lp->head->prev = c;
+	lp->head = c;
+}
+
+static void io_loop_unlink(S_IO_LOOP *lp, S_CONN *c)
+{
+	if (c->prev) c->prev->next = c->next;
+	else         lp->head      = c->next;
+	if (c->next) c->next->prev = c->prev;
+	c->prev = c->next = NULL;
+}
+
+static S_CONN *io_loop_take_pending(S_IO_LOOP *lp)
+{
+	uint64_t v;
+	S_CONN  *c;
+
+	if (read(lp->evfd, &v, sizeof(v)) < 0 && errno != EAGAIN)
+		tcmg_log_dbg(D_CONN, "eventfd read failed errno=%d (%s)", errno, strerror(errno));
+
+	pthread_mutex_lock(&lp->mtx);
+	c = lp->pending;
+	lp->pending = NULL;
+	pthread_mutex_unlock(&lp->mtx);
+	return c;
+}
+
+static inline bool job_before(const S_JOB *a, const S_JOB *b)
+{
+	if (a->prio != b->prio) return a->prio < b->prio;
+	return a->deadline_ms < b->deadline_ms;
+}
+
+static void jobq_push(S_JOB *j)
+{
+	int32_t i = s_jobq_len++;
+
+	while (i > 0)
+	{
+		int32_t up = (i - 1) / 2;
+		if (!job_before(j, s_jobq[up])) break;
+		s_jobq[i] = s_jobq[up];
+		i = up;
+	}
+	s_jobq[i] = j;
+}
+
+static S_JOB *jobq_pop(void)
+{
+	S_JOB  *top  = s_jobq[0];
+	S_JOB  *last = s_jobq[--s_jobq_len];
+	int32_t i    = 0;
+
+	for (;;)
+	{
+		int32_t k = 2 * i + 1;
+		if (k >= s_jobq_len) break;
+		if (k + 1 < s_jobq_len && job_before(s_jobq[k + 1], s_jobq[k])) k++;
+		if (!job_before(s_jobq[k], last)) break;
+		s_jobq[i] = s_jobq[k];
+		i = k;
+	}
+	s_jobq[i] = last;
+	return top;
+}
+
+static bool job_dispatch(S_JOB *j)
+{
+	pthread_mutex_lock(&s_jobq_mtx);
+	if (!s_workers_running)
+	{
+		pthread_mutex_unlock(&s_jobq_mtx);
+		return false;
+	}
+	if (s_jobq_len == s_jobq_cap)
+	{
+		int32_t cap = s_jobq_cap ? s_jobq_cap * 2 : 256;
+		S_JOB **q   = (S_JOB **)realloc(s_jobq, sizeof(S_JOB *) * (size_t)cap);
+		if (!q)
+		{
+			pthread_mutex_unlock(&s_jobq_mtx);
+			return false;
+		}
+		s_jobq     = q;
+		s_jobq_cap = cap;
+	}
+	jobq_push(j);
+	atomic_store_explicit(&s_jobq_depth, s_jobq_len, memory_order_relaxed);
+	pthread_cond_signal(&s_jobq_cond);
+	pthread_mutex_unlock(&s_jobq_mtx);
+	return true;
+}
+
+static void conn_job_start(S_CONN *c, S_JOB *j)
+{
+	c->jobs++;
+	if (job_dispatch(j)) return;
+	c->jobs--;
+	j->run(j);
+	j->done(j);
+	job_free(j);
+}
+
+static void *job_worker_thread(void *arg)
+{
+	(void)arg;
+	log_set_type(LOG_TYPE_CLIENT);
+
+	for (;;)
+	{
+		S_JOB *j;
+
+		pthread_mutex_lock(&s_jobq_mtx);
+		while (!s_jobq_len && s_workers_running)
+			pthread_cond_wait(&s_jobq_cond, &s_jobq_mtx);
+		j = s_jobq_len ? jobq_pop() : NULL;
+		atomic_store_explicit(&s_jobq_depth, s_jobq_len, memory_order_relaxed);
+		pthread_mutex_unlock(&s_jobq_mtx);
+		if (!j) break;
+
+		if (j->deadline_ms && tcmg_mono_ms() >= j->deadline_ms)
+		{
+			j->expired = 1;
+			atomic_fetch_add_explicit(&s_jobs_expired, 1, memory_order_relaxed);
+		}
+		else
+		{
+			j->run(j);
+			log_set_user(NULL);
+		}
+
+		S_IO_LOOP *lp  = &s_loops[j->conn->loop];
+		uint64_t   one = 1;
+		pthread_mutex_lock(&lp->mtx);
+		j->next  = lp->done;
+		lp->done = j;
+		pthread_mutex_unlock(&lp->mtx);
+		if (write(lp->evfd, &one, sizeof(one)) < 0)
+			tcmg_log_dbg(D_CONN, "eventfd write failed errno=%d", errno);
+	}
+
+	return NULL;
+}
+
+static int32_t job_workers_start(int32_t n)
+{
+	if (n <= 0)
+	{
+		long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		n = 2 * (ncpu > 0 ? (int32_t)ncpu : 1);
+	}
+	if (n > ECM_WORKERS_MAX) n = ECM_WORKERS_MAX;
+
+	s_workers = (pthread_t *)tcmg_malloc(sizeof(pthread_t) * (size_t)n);
+	if (!s_workers) return 0;
+
+	s_workers_running = 1;
+	for (s_nworkers = 0; s_nworkers < n; s_nworkers++)
+		if (pthread_create(&s_workers[s_nworkers], NULL, job_worker_thread, NULL) != 0)
+			break;
+	if (s_nworkers == 0)
+	{
+		tcmg_log("pthread_create failed errno=%d (%s) -- ECMs decoded on the event loop",
+		         errno, strerror(errno));
+		s_workers_running = 0;
+		free(s_workers);
+		s_workers = NULL;
+	}
+	return s_nworkers;
+}
+
+static void job_workers_stop(void)
+{
+	pthread_mutex_lock(&s_jobq_mtx);
+	s_workers_running = 0;
+	pthread_cond_broadcast(&s_jobq_cond);
+	pthread_mutex_unlock(&s_jobq_mtx);
+	for (int32_t i = 0; i < s_nworkers; i++)
+		pthread_join(s_workers[i], NULL);
+	free(s_workers);
+	free(s_jobq);
+	s_workers  = NULL;
+	s_nworkers = 0;
+	s_jobq     = NULL;
+	s_jobq_cap = 0;
+}
+
+static void io_loop_jobs_done(S_IO_LOOP *lp)
+{
+	S_JOB *j = NULL, *next;
+
+	pthread_mutex_lock(&lp->mtx);
+	for (S_JOB *d = lp->done; d; d = next)
+	{
+		next    = d->next;
+		d->next = j;
+		j       = d;
+	}
+	lp->done = NULL;
+	pthread_mutex_unlock(&lp->mtx);
+
+	for (; j; j = next)
+	{
+		S_CONN *c = j->conn;
+		next = j->next;
+		c->jobs--;
+		if (!c->dead)
+		{
+			log_set_user(c->cl.user);
+			j->done(j);
+			if (c->backlog && !c->closing)
+			{
+				S_JOB *b = c->backlog;
+				if (!(c->backlog = b->next)) c->backlog_tail = NULL;
+				c->nbacklog--;
+				conn_job_start(c, b);
+			}
+			if (c->closing)
+				io_loop_drop(lp, c, true);
+		}
+		job_free(j);
+	}
+	log_set_user(NULL);
+}
+
+static void io_loop_reap_dead(S_IO_LOOP *lp)
+{
+	S_CONN **pp = &lp->dead;
+
+	while (*pp)
+	{
+		S_CONN *c = *pp;
+		if (c->inflight || c->dirty || c->jobs || !clients_grace_passed(c->grace))
+		{
+			pp = &c->next;
+			continue;
+		}
+		*pp = c->next;
+		conn_free(c);
+	}
+}
+
+static void io_loop_tick(S_IO_LOOP *lp, int64_t now)
+{
+	int64_t tmo = (int64_t)g_cfg.sock_timeout * 1000;
+	S_CONN *c, *next;
+
+	for (c = lp->head; c; c = next)
+	{
+		next = c->next;
+		log_set_user(c->cl.user);
+		client_relink_account(&c->cl);
+		if (c->cl.kill_flag || !g_running)
+			io_loop_drop(lp, c, false);
+		else if (now - c->last_rx_ms >= tmo)
+		{
+			tcmg_log_dbg(D_CONN, "%s [%s] no data for %ds -- timeout",
+			             c->cl.ip, c->ops->name, g_cfg.sock_timeout);
+			io_loop_drop(lp, c, true);
+		}
+		else if (c->ops->on_tick(c) < 0)
+			io_loop_drop(lp, c, false);
+	}
+	log_set_user(NULL);
+}
+
+static void io_loop_shutdown(S_IO_LOOP *lp)
+{
+	io_loop_jobs_done(lp);
+	while (lp->head)
+		io_loop_drop(lp, lp->head, false);
+	for (S_CONN *c = io_loop_take_pending(lp), *next; c; c = next)
+	{
+		next = c->next;
+		atomic_fetch_sub(&lp->nconns, 1);
+		conn_close(c, false);
+	}
+	io_loop_reap_dead(lp);
+}
+
+#ifdef ENGINE_HAVE_URING
+
+static int uring_enter(S_URING *u, uint32_t submit, uint32_t wait)
+{
+	return (int)syscall(__NR_io_uring_enter, u->fd, submit, wait,
+	                    wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+}
+
+static void uring_flush_sq(S_URING *u, uint32_t wait)
+{
+	uint32_t n = u->sq_local - u->sq_flushed;
+
+	__atomic_store_n(u->sq_tail, u->sq_local, __ATOMIC_RELEASE);
+	for (;;)
+	{
+		int rc = uring_enter(u, n, wait);
+		atomic_fetch_add_explicit(&s_io_enter, 1, memory_order_relaxed);
+		if (rc >= 0) { u->sq_flushed += (uint32_t)rc; return; }
+		if (errno == EINTR) { if (wait) return; continue; }
+		if (errno == EAGAIN || errno == EBUSY) return;
+		tcmg_log_dbg(D_CONN, "io_uring_enter failed errno=%d (%s)", errno, strerror(errno));
+		return;
+	}
+}
+
+static struct io_uring_sqe *uring_sqe(S_URING *u, uint64_t data, uint8_t op)
+{
+	struct io_uring_sqe *sqe;
+	uint32_t             idx;
+
+	if (u->sq_local - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) >= u->sq_entries)
+		uring_flush_sq(u, 0);
+	idx = u->sq_local & *u->sq_mask;
+	sqe = &u->sqes[idx];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode      = op;
+	sqe->user_data   = data;
+	u->sq_array[idx] = idx;
+	u->sq_local++;
+	return sqe;
+}
+
+static void uring_buf_put(S_URING *u, uint16_t bid)
+{
+	struct io_uring_buf *b = &u->br->bufs[u->br_tail & (IO_URING_BUFS - 1)];
+
+	b->addr = (uint64_t)(uintptr_t)(u->bufs + (size_t)bid * IO_URING_BUF_SIZE);
+	b->len  = IO_URING_BUF_SIZE;
+	b->bid  = bid;
+	u->br_tail++;
+	__atomic_store_n(&u->br->tail, u->br_tail, __ATOMIC_RELEASE);
+}
+
+static void uring_arm_recv(S_URING *u, S_CONN *c)
+{
+	struct io_uring_sqe *sqe = uring_sqe(u, (uint64_t)(uintptr_t)c | URING_OP_RECV, IORING_OP_RECV);
+
+	sqe->fd        = c->cl.fd;
+	sqe->flags     = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_BGID;
+	sqe->ioprio    = u->single_shot ? 0 : IORING_RECV_MULTISHOT;
+	c->inflight   |= URING_OP_RECV;
+}
+
+static void uring_arm_wake(S_IO_LOOP *lp)
+{
+	S_URING             *u   = lp->ring;
+	struct io_uring_sqe *sqe = uring_sqe(u, URING_OP_WAKE, IORING_OP_POLL_ADD);
+
+	sqe->fd            = lp->evfd;
+	sqe->poll32_events = POLLIN;
+}
+
+static void uring_arm_tick(S_URING *u)
+{
+	struct io_uring_sqe *sqe = uring_sqe(u, URING_OP_TICK, IORING_OP_TIMEOUT);
+
+	u->tick.tv_sec  = ENGINE_TICK_MS / 1000;
+	u->tick.tv_nsec = (ENGINE_TICK_MS % 1000) * 1000000L;
+	sqe->addr = (uint64_t)(uintptr_t)&u->tick;
+	sqe->len  = 1;
+	sqe->off  = 0;
+}
+
+static void uring_mark_dirty(S_URING *u, S_CONN *c)
+{
+	if (c->dirty) return;
+	c->dirty  = 1;
+	c->wnext  = u->dirty;
+	u->dirty  = c;
+}
+
+static void uring_flush_dirty(S_URING *u)
+{
+	S_CONN *c = u->dirty;
+
+	u->dirty = NULL;
+	while (c)
+	{
+		S_CONN *next = c->wnext;
+		c->dirty = 0;
+		c->wnext = NULL;
+		if (!c->dead && !(c->inflight & URING_OP_SEND) && c->woff < c->wlen)
+		{
+			struct io_uring_sqe *sqe = uring_sqe(u, (uint64_t)(uintptr_t)c | URING_OP_SEND, IORING_OP_SEND);
+			sqe->fd        = c->cl.fd;
+			sqe->addr      = (uint64_t)(uintptr_t)(c->wbuf + c->woff);
+			sqe->len       = c->wlen - c->woff;
+			sqe->msg_flags = MSG_NOSIGNAL;
+			c->inflight   |= URING_OP_SEND;
+		}
+		c = next;
+	}
+}
+
+static void uring_on_recv(S_IO_LOOP *lp, S_CONN *c, const struct io_uring_cqe *cqe)
+{
+	S_URING *u    = lp->ring;
+	bool     more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+	int32_t  rc   = 1;
+
+	if (!more) c->inflight &= (uint8_t)~URING_OP_RECV;
+
+	if (cqe->flags & IORING_CQE_F_BUFFER)
+	{
+		uint16_t bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+		if (!c->dead && cqe->res > 0)
+		{
+			log_set_user(c->cl.user);
+			rc = conn_feed(c, u->bufs + (size_t)bid * IO_URING_BUF_SIZE, (uint32_t)cqe->res);
+		}
+		uring_buf_put(u, bid);
+	}
+	if (c->dead) return;
+
+	if (cqe->res == -EINVAL && !u->single_shot)
+	{
+		tcmg_log("%s", "io_uring multishot recv unsupported -- using single-shot recv");
+		u->single_shot = 1;
+	}
+	else if (cqe->res == 0)
+		rc = 0;
+	else if (cqe->res < 0 && cqe->res != -ENOBUFS && cqe->res != -EINTR)
+		rc = 0;
+
+	if (rc <= 0)
+		io_loop_drop(lp, c, rc == 0);
+	else if (!(c->inflight & URING_OP_RECV))
+		uring_arm_recv(u, c);
+}
+
+static void uring_on_send(S_IO_LOOP *lp, S_CONN *c, const struct io_uring_cqe *cqe)
+{
+	S_URING *u = lp->ring;
+
+	c->inflight &= (uint8_t)~URING_OP_SEND;
+	if (c->wold)
+	{
+		free(c->wold);
+		c->wold = NULL;
+	}
+	if (c->dead) return;
+
+	if (cqe->res < 0)
+	{
+		log_set_user(c->cl.user);
+		io_loop_drop(lp, c, true);
+		return;
+	}
+	c->woff += (uint32_t)cqe->res;
+	if (c->woff >= c->wlen)
+		c->woff = c->wlen = 0;
+	else
+		uring_mark_dirty(u, c);
+}
+
+static void uring_cancel(S_URING *u, S_CONN *c)
+{
+	shutdown(c->cl.fd, SHUT_RDWR);
+	if (c->inflight & URING_OP_RECV)
+	{
+		struct io_uring_sqe *sqe = uring_sqe(u, URING_OP_CANCEL, IORING_OP_ASYNC_CANCEL);
+		sqe->addr = (uint64_t)(uintptr_t)c | URING_OP_RECV;
+	}
+}
+
+static int32_t uring_reap(S_IO_LOOP *lp)
+{
+	S_URING *u    = lp->ring;
+	uint32_t head = *u->cq_head;
+	uint32_t tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+	int32_t  n    = 0;
+
+	for (; head != tail; head++, n++)
+	{
+		struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+		S_CONN              *c   = (S_CONN *)(uintptr_t)(cqe->user_data & ~(uint64_t)URING_OP_MASK);
+
+		switch (cqe->user_data & URING_OP_MASK)
+		{
+		case URING_OP_RECV: uring_on_recv(lp, c, cqe); break;
+		case URING_OP_SEND: uring_on_send(lp, c, cqe); break;
+		case URING_OP_WAKE:
+			c = io_loop_take_pending(lp);
+			io_loop_jobs_done(lp);
+			for (S_CONN *p = c, *next; p; p = next)
+			{
+				next = p->next;
+				io_loop_link(lp, p);
+				if (conn_open(p) < 0)
+					io_loop_drop(lp, p, p->closing);
+				else
+					uring_arm_recv(u, p);
+			}
+			if (s_engine_running) uring_arm_wake(lp);
+			break;
+		case URING_OP_TICK:
+			if (s_engine_running) uring_arm_tick(u);
+			break;
+		default:
+			break;
+		}
+	}
+	__atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+	log_set_user(NULL);
+	return n;
+}
+
+static void uring_destroy(S_URING *u)
+{
+	if (!u) return;
+	if (u->fd >= 0) close(u->fd);
+	if (u->sqes && u->sqes != MAP_FAILED) munmap(u->sqes, u->sqe_map_sz);
+	if (u->cq_map && u->cq_map != MAP_FAILED && u->cq_map != u->sq_map) munmap(u->cq_map, u->cq_map_sz);
+	if (u->sq_map && u->sq_map != MAP_FAILED) munmap(u->sq_map, u->sq_map_sz);
+	if (u->br && u->br != MAP_FAILED) munmap(u->br, u->br_sz);
+	if (u->bufs)
+	{
+		secure_zero(u->bufs, (size_t)IO_URING_BUFS * IO_URING_BUF_SIZE);
+		free(u->bufs);
+	}
+	free(u);
+}
+
+static S_URING *uring_create(void)
+{
+	struct io_uring_params  p;
+	struct io_uring_buf_reg reg;
+	S_URING                *u;
+	uint8_t                *sq, *cq;
+
+	memset(&p, 0, sizeof(p));
+	p.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+	p.cq_entries = IO_URING_CQ_ENTRIES;
+	int fd = (int)syscall(__NR_io_uring_setup, IO_URING_SQ_ENTRIES, &p);
+	if (fd < 0 && errno == EINVAL)
+	{
+		memset(&p, 0, sizeof(p));
+		p.flags      = IORING_SETUP_CQSIZE;
+		p.cq_entries = IO_URING_CQ_ENTRIES;
+		fd = (int)syscall(__NR_io_uring_setup, IO_URING_SQ_ENTRIES, &p);
+	}
+	if (fd < 0) return NULL;
+
+	u = (S_URING *)tcmg_malloc(sizeof(S_URING));
+	if (!u) { close(fd); return NULL; }
+	u->fd         = fd;
+	u->sq_entries = p.sq_entries;
+	u->sq_map_sz  = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+	u->cq_map_sz  = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	u->sqe_map_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (u->cq_map_sz > u->sq_map_sz) u->sq_map_sz = u->cq_map_sz;
+		u->cq_map_sz = u->sq_map_sz;
+	}
+
+	u->sq_map = mmap(NULL, u->sq_map_sz, PROT_READ | PROT_WRITE,
+	                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (u->sq_map == MAP_FAILED) { uring_destroy(u); return NULL; }
+	u->cq_map = (p.features & IORING_FEAT_SINGLE_MMAP) ? u->sq_map :
+	            mmap(NULL, u->cq_map_sz, PROT_READ | PROT_WRITE,
+	                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	u->sqes   = (struct io_uring_sqe *)mmap(NULL, u->sqe_map_sz, PROT_READ | PROT_WRITE,
+	                                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (u->cq_map == MAP_FAILED || u->sqes == MAP_FAILED) { uring_destroy(u); return NULL; }
+
+	sq = (uint8_t *)u->sq_map;
+	cq = (uint8_t *)u->cq_map;
+	u->sq_head  = (uint32_t *)(sq + p.sq_off.head);
+	u->sq_tail  = (uint32_t *)(sq + p.sq_off.tail);
+	u->sq_mask  = (uint32_t *)(sq + p.sq_off.ring_mask);
+	u->sq_array = (uint32_t *)(sq + p.sq_off.array);
+	u->cq_head  = (uint32_t *)(cq + p.cq_off.head);
+	u->cq_tail  = (uint32_t *)(cq + p.cq_off.tail);
+	u->cq_mask  = (uint32_t *)(cq + p.cq_off.ring_mask);
+	u->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+	u->sq_local = u->sq_flushed = *u->sq_tail;
+
+	u->br_sz = IO_URING_BUFS * sizeof(struct io_uring_buf);
+	u->br    = (struct io_uring_buf_ring *)mmap(NULL, u->br_sz, PROT_READ | PROT_WRITE,
+	                                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	u->bufs  = (uint8_t *)malloc((size_t)IO_URING_BUFS * IO_URING_BUF_SIZE);
+	if (u->br == MAP_FAILED || !u->bufs) { uring_destroy(u); return NULL; }
+
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr    = (uint64_t)(uintptr_t)u->br;
+	reg.ring_entries = IO_URING_BUFS;
+	reg.bgid         = URING_BGID;
+	if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+	{
+		uring_destroy(u);
+		return NULL;
+	}
+	for (uint16_t bid = 0; bid < IO_URING_BUFS; bid++)
+		uring_buf_put(u, bid);
+	return u;
+}
+
+static void *uring_loop_thread(void *arg)
+{
+	S_IO_LOOP *lp = (S_IO_LOOP *)arg;
+	S_URING   *u  = lp->ring;
+	int64_t    last_tick = tcmg_mono_ms();
+
+	log_set_type(LOG_TYPE_CLIENT);
+	uring_arm_wake(lp);
+	uring_arm_tick(u);
+
+	while (s_engine_running)
+	{
+		uring_flush_sq(u, 1);
+		uring_reap(lp);
+		uring_flush_dirty(u);
+		io_loop_reap_dead(lp);
+
+		int64_t now = tcmg_mono_ms();
+		if (now - last_tick >= ENGINE_TICK_MS)
+		{
+			last_tick = now;
+			io_loop_tick(lp, now);
+			uring_flush_dirty(u);
+		}
+	}
+
+	io_loop_shutdown(lp);
+	for (int i = 0; i < 50 && lp->dead; i++)
+	{
+		uring_arm_tick(u);
+		uring_flush_sq(u, 1);
+		uring_reap(lp);
+		io_loop_reap_dead(lp);
+	}
+	if (lp->dead)
+		tcmg_log("%s", "io_uring requests still pending at shutdown -- leaking connection buffers");
+
+	return NULL;
+}
+
+#endif
+
+static void io_loop_drop(S_IO_LOOP *lp, S_CONN *c, bool peer)
+{
+	io_loop_unlink(lp, c);
+	atomic_fetch_sub(&lp->nconns, 1);
+	c->dead = 1;
+#ifdef ENGINE_HAVE_URING
+	if (lp->ring)
+		uring_cancel(lp->ring, c);
+	else
+#endif
+	epoll_ctl(lp->epfd, EPOLL_CTL_DEL, c->cl.fd, NULL);
+	while (c->backlog)
+	{
+		S_JOB *b = c->backlog;
+		c->backlog = b->next;
+		job_free(b);
+	}
+	c->backlog_tail = NULL;
+	c->nbacklog     = 0;
+	conn_retire(c, peer);
+	c->next  = lp->dead;
+	lp->dead = c;
+}
+
+static void io_loop_adopt(S_IO_LOOP *lp)
+{
+	S_CONN *c, *next;
+
+	for (c = io_loop_take_pending(lp); c; c = next)
+	{
+		struct epoll_event ev;
+		next = c->next;
+		io_loop_link(lp, c);
+
+		net_set_blocking(c->cl.fd, false);
+		memset(&ev, 0, sizeof(ev));
+		ev.events   = EPOLLIN | EPOLLRDHUP;
+		ev.data.ptr = c;
+		if (epoll_ctl(lp->epfd, EPOLL_CTL_ADD, c->cl.fd, &ev) < 0)
+		{
+			tcmg_log("%s [%s] epoll_ctl failed errno=%d (%s)",
+			         c->cl.ip, c->ops->name, errno, strerror(errno));
+			io_loop_drop(lp, c, false);
+			continue;
+		}
+		if (conn_open(c) < 0)
+			io_loop_drop(lp, c, c->closing);
+	}
+}
+
+static void conn_poll_out(S_CONN *c, bool on)
+{
+	struct epoll_event ev;
+	if (c->wpoll == (int8_t)on) return;
+	memset(&ev, 0, sizeof(ev));
+	ev.events   = EPOLLIN | EPOLLRDHUP | (on ? EPOLLOUT : 0);
+	ev.data.ptr = c;
+	epoll_ctl(s_loops[c->loop].epfd, EPOLL_CTL_MOD, c->cl.fd, &ev);
+	c->wpoll = (int8_t)on;
+}
+
+static bool conn_queue(S_CONN *c, const uint8_t *p, uint32_t n)
+{
+	uint32_t used = c->wlen - c->woff;
+	bool     busy = (c->inflight & URING_OP_SEND) != 0;
+
+	if (used + n > CONN_WBUF_MAX)
+	{
+		tcmg_log("%s [%s] send queue overflow queued=%u -- disconnecting",
+		         c->cl.ip, c->ops->name, used);
+		c->closing = 1;
+		return false;
+	}
+	if (c->woff && !busy)
+	{
+		memmove(c->wbuf, c->wbuf + c->woff, used);
+		c->woff = 0;
+		c->wlen = used;
+	}
+	if (c->wlen + n > c->wcap)
+	{
+		uint32_t cap = c->wcap ? c->wcap : 2048;
+		while (cap < c->wlen + n) cap *= 2;
+		uint8_t *nb = (uint8_t *)malloc(cap);
+		if (!nb)
+		{
+			c->closing = 1;
+			return false;
+		}
+		if (c->wbuf)
+		{
+			memcpy(nb, c->wbuf, c->wlen);
+			if (busy && !c->wold)
+				c->wold = c->wbuf;
+			else
+			{
+				secure_zero(c->wbuf, c->wcap);
+				free(c->wbuf);
+			}
+		}
+		c->wbuf = nb;
+		c->wcap = cap;
+	}
+	memcpy(c->wbuf + c->wlen, p, n);
+	c->wlen += n;
+	return true;
+}
+
+static int32_t conn_flush(S_CONN *c)
+{
+	while (c->woff < c->wlen)
+	{
+		ssize_t n = send(c->cl.fd, c->wbuf + c->woff, c->wlen - c->woff, MSG_NOSIGNAL);
+		atomic_fetch_add_explicit(&s_io_send, 1, memory_order_relaxed);
+		if (n > 0) { c->woff += (uint32_t)n; continue; }
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+		return 0;
+	}
+	c->woff = c->wlen = 0;
+	conn_poll_out(c, false);
+	return 1;
+}
+
+static int32_t conn_read(S_CONN *c)
+{
+	uint8_t buf[CONN_IBUF_SIZE];
+
+	for (int32_t i = 0; i < CONN_READ_BURST; i++)
+	{
+		ssize_t n = recv(c->cl.fd, buf, sizeof(buf), 0);
+		atomic_fetch_add_explicit(&s_io_recv, 1, memory_order_relaxed);
+		if (n > 0)
+		{
+			int32_t rc = conn_feed(c, buf, (uint32_t)n);
+			if (rc <= 0 || (size_t)n < sizeof(buf)) return rc;
+			continue;
+		}
+		if (n == 0) return 0;
+		if (errno == EINTR) continue;
+		if (errno == EAGAIN || errno == EWOULDBLOCK) return 1;
+		return 0;
+	}
+	return 1;
+}
+
+static void *io_loop_thread(void *arg)
+{
+	S_IO_LOOP         *lp = (S_IO_LOOP *)arg;
+	struct epoll_event ev[64];
+	int64_t            last_tick = tcmg_mono_ms();
+
+	log_set_type(LOG_TYPE_CLIENT);
+
+	while (s_engine_running)
+	{
+		int n = epoll_wait(lp->epfd, ev, 64, ENGINE_TICK_MS);
+		for (int i = 0; i < n; i++)
+		{
+			S_CONN *c = (S_CONN *)ev[i].data.ptr;
+			int32_t rc = 1;
+
+			if (!c)
+			{
+				io_loop_adopt(lp);
+				io_loop_jobs_done(lp);
+				continue;
+			}
+			if (c->dead) continue;
+
+			log_set_user(c->cl.user);
+			if (ev[i].events & EPOLLOUT)
+				rc = conn_flush(c);
+			if (rc > 0 && (ev[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)))
+				rc = conn_read(c);
+			if (rc <= 0)
+				io_loop_drop(lp, c, rc == 0);
+		}
+		log_set_user(NULL);
+		io_loop_reap_dead(lp);
+
+		int64_t now = tcmg_mono_ms();
+		if (now - last_tick >= ENGINE_TICK_MS)
+		{
+			last_tick = now;
+			io_loop_tick(lp, now);
+		}
+	}
+
+	io_loop_shutdown(lp);
+	return NULL;
+}
+
+static void io_loops_free(int32_t n)
+{
+	for (int32_t i = 0; i < n; i++)
+	{
+		if (s_loops[i].epfd >= 0) close(s_loops[i].epfd);
+		if (s_loops[i].evfd >= 0) close(s_loops[i].evfd);
+#ifdef ENGINE_HAVE_URING
+		uring_destroy(s_loops[i].ring);
+#endif
+		pthread_mutex_destroy(&s_loops[i].mtx);
+	}
+	free(s_loops);
+	s_loops  = NULL;
+	s_nloops = 0;
+}
+
+bool engine_start(int32_t nthreads, const char *backend, int32_t nworkers)
+{
+	bool    uring = false;
+	int32_t i;
+
+	if (nthreads <= 0)
+	{
+		long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = ncpu > 0 ? (int32_t)ncpu : 1;
+	}
+	if (nthreads > IO_THREADS_MAX) nthreads = IO_THREADS_MAX;
+
+	if (backend && strcasecmp(backend, "io_uring") == 0)
+	{
+#ifdef ENGINE_HAVE_URING
+		uring = true;
+#else
+		tcmg_log("%s", "io_uring not available in this build -- using epoll");
+#endif
+	}
+
+	s_loops = (S_IO_LOOP *)tcmg_malloc(sizeof(S_IO_LOOP) * (size_t)nthreads);
+	if (!s_loops) return false;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		S_IO_LOOP         *lp = &s_loops[i];
+		struct epoll_event ev;
+
+		pthread_mutex_init(&lp->mtx, NULL);
+		lp->epfd = epoll_create1(EPOLL_CLOEXEC);
+		lp->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		if (lp->epfd < 0 || lp->evfd < 0 ||
+		    epoll_ctl(lp->epfd, EPOLL_CTL_ADD, lp->evfd, &ev) < 0)
+		{
+			tcmg_log("epoll setup failed errno=%d (%s) -- using one thread per connection",
+			         errno, strerror(errno));
+			io_loops_free(i + 1);
+			return false;
+		}
+#ifdef ENGINE_HAVE_URING
+		if (uring && !(lp->ring = uring_create()))
+		{
+			tcmg_log("io_uring setup failed errno=%d (%s) -- using epoll",
+			         errno, strerror(errno));
+			for (int32_t j = 0; j < i; j++)
+			{
+				uring_destroy(s_loops[j].ring);
+				s_loops[j].ring = NULL;
+			}
+			uring = false;
+		}
+#endif
+	}
+
+	s_engine_running = 1;
+	for (i = 0; i < nthreads; i++)
+	{
+		void *(*fn)(void *) = io_loop_thread;
+#ifdef ENGINE_HAVE_URING
+		if (s_loops[i].ring) fn = uring_loop_thread;
+#endif
+		if (pthread_create(&s_loops[i].tid, NULL, fn, &s_loops[i]) != 0)
+			break;
+	}
+	s_nloops = i;
+
+	if (s_nloops == 0)
+	{
+		tcmg_log("pthread_create failed errno=%d (%s) -- using one thread per connection",
+		         errno, strerror(errno));
+		s_engine_running = 0;
+		io_loops_free(nthreads);
+		return false;
+	}
+
+	nworkers = job_workers_start(nworkers);
+	if (uring)
+		tcmg_log("io_uring engine started io_threads=%d ecm_workers=%d recv_bufs=%dx%d",
+		         s_nloops, nworkers, IO_URING_BUFS, IO_URING_BUF_SIZE);
+	else
+		tcmg_log("epoll engine started io_threads=%d ecm_workers=%d", s_nloops, nworkers);
+	return true;
+}
+
+void engine_stop(void)
+{
+	int32_t n = s_nloops;
+
+	if (!s_engine_running) return;
+	job_workers_stop();
+	s_engine_running = 0;
+	for (int32_t i = 0; i < n; i++)
+	{
+		uint64_t one = 1;
+		if (write(s_loops[i].evfd, &one, sizeof(one)) < 0)
+			tcmg_log_dbg(D_CONN, "eventfd write failed errno=%d", errno);
+	}
+	for (int32_t i = 0; i < n; i++)
+		pthread_join(s_loops[i].tid, NULL);
+	io_loops_free(n);
+	tcmg_log_dbg(D_CONN, "%s", "engine stopped");
+}
+
+#else
+
+bool engine_start(int32_t nthreads, const char *backend, int32_t nworkers)
+{
+	(void)nthreads;
+	(void)backend;
+	(void)nworkers;
+	tcmg_log("%s", "using one thread per connection");
+	return false;
+}
+
+void engine_stop(void)
+{
+}
+
+#endif
+
+int32_t conn_write(S_CONN *c, const void *buf, int32_t len)
+{
+	if (c->closing) return -1;
+
+#ifdef ENGINE_HAVE_EPOLL
+	if (c->loop >= 0)
+	{
+		const uint8_t *p   = (const uint8_t *)buf;
+		int32_t        off = 0;
+
+#ifdef ENGINE_HAVE_URING
+		S_URING *u = s_loops[c->loop].ring;
+		if (u)
+		{
+			if (!conn_queue(c, p, (uint32_t)len)) return -1;
+			uring_mark_dirty(u, c);
+			return len;
+		}
+#endif
+		if (c->woff == c->wlen)
+		{
+			while (off < len)
+			{
+				ssize_t n = send(c->cl.fd, p + off, len - off, MSG_NOSIGNAL);
+				atomic_fetch_add_explicit(&s_io_send, 1, memory_order_relaxed);
+				if (n > 0) { off += (int32_t)n; continue; }
+				if (n < 0 && errno == EINTR) continue;
+				if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+				c->closing = 1;
+				return -1;
+			}
+			if (off == len) return len;
+		}
+		if (!conn_queue(c, p + off, (uint32_t)(len - off))) return -1;
+		conn_poll_out(c, true);
+		return len;
+	}
+#endif
+
+	atomic_fetch_add_explicit(&s_io_send, 1, memory_order_relaxed);
+	if (net_send_all(c->cl.fd, buf, len) != len)
+	{
+		c->closing = 1;
+		return -1;
+	}
+	return len;
+}
+
+bool engine_job_submit(S_JOB *j)
+{
+#ifdef ENGINE_HAVE_EPOLL
+	S_CONN *c = j->conn;
+
+	if (c->loop >= 0 && s_nworkers > 0)
+	{
+		if (c->jobs < (c->ops->ordered ? 1 : (uint16_t)g_cfg.ecm_inflight))
+		{
+			conn_job_start(c, j);
+			return true;
+		}
+		if (c->nbacklog >= ECM_BACKLOG_MAX)
+			return false;
+		j->next = NULL;
+		if (c->backlog_tail) c->backlog_tail->next = j;
+		else                 c->backlog            = j;
+		c->backlog_tail = j;
+		c->nbacklog++;
+		return true;
+	}
+#endif
+
+	j->run(j);
+	j->done(j);
+	job_free(j);
+	return true;
+}
+
+bool engine_attach(int fd, const char *ip, const S_CONN_OPS *ops)
+{
+	S_CONN *c = (S_CONN *)tcmg_malloc(ops->size);
+	if (!c) return false;
+
+	c->ops              = ops;
+	c->cl.fd            = fd;
+	c->cl.conn          = c;
+	c->cl.thread_id     = atomic_fetch_add(&s_conn_id, 1) + 1;
+	c->cl.connect_time  = time(NULL);
+	c->cl.last_ecm_time = time(NULL);
+	tcmg_strlcpy(c->cl.ip, ip, MAXIPLEN);
+	tcmg_strlcpy(c->cl.proto, ops->name, sizeof(c->cl.proto));
+
+#ifdef ENGINE_HAVE_EPOLL
+	if (s_engine_running)
+	{
+		int32_t best = 0;
+		for (int32_t i = 1; i < s_nloops; i++)
+			if (s_loops[i].nconns < s_loops[best].nconns) best = i;
+
+		S_IO_LOOP *lp = &s_loops[best];
+		uint64_t   one = 1;
+		c->loop = best;
+		atomic_fetch_add(&lp->nconns, 1);
+		pthread_mutex_lock(&lp->mtx);
+		c->next     = lp->pending;
+		lp->pending = c;
+		pthread_mutex_unlock(&lp->mtx);
+		if (write(lp->evfd, &one, sizeof(one)) < 0)
+			tcmg_log_dbg(D_CONN, "eventfd write failed errno=%d", errno);
+		return true;
+	}
+#endif
+
+	pthread_attr_t attr;
+	pthread_t      tid;
+	int            rc;
+
+	c->loop = -1;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	pthread_attr_setstacksize(&attr, 256 * 1024);
+	rc = pthread_create(&tid, &attr, conn_thread, c);
+	pthread_attr_destroy(&attr);
+	if (rc != 0)
+	{
+		tcmg_log("pthread_create failed: rc=%d errno=%d (%s)", rc, errno, strerror(errno));
+		free(c);
+		return false;
+	}
+	return true;
+}
+
+bool engine_ecm_admit(void)
+{
+	if (g_cfg.admit_queue > 0 &&
+	    atomic_load_explicit(&s_jobq_depth, memory_order_relaxed) >= g_cfg.admit_queue)
+		goto shed;
+
+	if (g_cfg.admit_latency_ms > 0 &&
+	    atomic_load_explicit(&s_ecm_lat16, memory_order_relaxed) / 16 >= g_cfg.admit_latency_ms)
+	{
+		int64_t now  = tcmg_mono_ms();
+		int64_t last = atomic_load_explicit(&s_admit_probe_ms, memory_order_relaxed);
+		if (now - last >= ADMIT_PROBE_MS &&
+		    atomic_compare_exchange_strong(&s_admit_probe_ms, &last, now))
+			return true;
+		goto shed;
+	}
+	return true;
+
+shed:
+	atomic_fetch_add_explicit(&s_ecm_shed, 1, memory_order_relaxed);
+	return false;
+}
+
+void engine_ecm_latency(int64_t ms)
+{
+	int32_t avg = atomic_load_explicit(&s_ecm_lat16, memory_order_relaxed);
+
+	if (ms < 0)     ms = 0;
+	if (ms > 60000) ms = 60000;
+	atomic_store_explicit(&s_ecm_lat16, avg + ((int32_t)ms * 16 - avg) / 8, memory_order_relaxed);
+}
+
+void engine_io_stats(S_IO_STATS *st)
+{
+	st->recv_calls  = atomic_load_explicit(&s_io_recv,  memory_order_relaxed);
+	st->send_calls  = atomic_load_explicit(&s_io_send,  memory_order_relaxed);
+	st->ring_enters = atomic_load_explicit(&s_io_enter, memory_order_relaxed);
+	st->ecm_expired = atomic_load_explicit(&s_jobs_expired, memory_order_relaxed);
+	st->ecm_shed    = atomic_load_explicit(&s_ecm_shed,     memory_order_relaxed);
+	st->ecm_queued  = atomic_load_explicit(&s_jobq_depth,   memory_order_relaxed);
+	st->ecm_lat_ms  = atomic_load_explicit(&s_ecm_lat16,    memory_order_relaxed) / 16;
+}
+
+void engine_io_stats_reset(void)
+{
+	atomic_store_explicit(&s_io_recv,  0, memory_order_relaxed);
+	atomic_store_explicit(&s_io_send,  0, memory_order_relaxed);
+	atomic_store_explicit(&s_io_enter, 0, memory_order_relaxed);
+	atomic_store_explicit(&s_jobs_expired, 0, memory_order_relaxed);
+	atomic_store_explicit(&s_ecm_shed,     0, memory_order_relaxed);
+}
@@ -0,0 +1,30 @@
+#ifndef TCMG_ENGINE_H_
+#define TCMG_ENGINE_H_
+
+bool    engine_start(int32_t nthreads, const char *backend, int32_t nworkers);
+void    engine_stop(void);
+bool    engine_attach(int fd, const char *ip, const S_CONN_OPS *ops);
+bool    engine_job_submit(S_JOB *j);
+bool    engine_ecm_admit(void);
+void    engine_ecm_latency(int64_t ms);
+int32_t conn_write(S_CONN *c, const void *buf, int32_t len);
+void    engine_io_stats(S_IO_STATS *st);
+void    engine_io_stats_reset(void);
+
+static inline void conn_expect(S_CONN *c, uint32_t n)
+{
+	c->rlen = 0;
+	c->want = n;
+}
+
+static inline bool conn_busy(const S_CONN *c)
+{
+	return c->jobs || c->nbacklog;
+}
+
+static inline S_CW_L1 *conn_l1(S_CONN *c)
+{
+	return c && c->loop >= 0 ? &c->l1 : NULL;
+}
+
+#endif
@@ -60,18 +60,78 @@ void net_tune_socket(int fd)
 	(void)one;
 }
 
-void nc_init(S_CLIENT *cl, const uint8_t *des_key14, int32_t timeout)
+void net_set_blocking(int fd, bool blocking)
 {
-	uint8_t rnd[14], spread[16];
+#ifdef TCMG_OS_WINDOWS
+	u_long nb = blocking ? 0 : 1;
+	ioctlsocket(fd, FIONBIO, &nb);
+#else
+	int fl = fcntl(fd, F_GETFL, 0);
+	if (fl < 0) return;
+	fcntl(fd, F_SETFL, blocking ? (fl & ~O_NONBLOCK) : (fl | O_NONBLOCK));
+#endif
+}
+
+int32_t net_acceptors(void)
+{
+#ifdef SO_REUSEPORT
+	int32_t n = g_cfg.accept_threads;
+	if (n <= 0)
+	{
+		long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		n = ncpu > 0 ? (int32_t)ncpu : 1;
+	}
+	return n > ACCEPT_THREADS_MAX ? ACCEPT_THREADS_MAX : n;
+#else
+	return 1;
+#endif
+}
 
-	net_set_timeout(cl->fd, timeout);
-	net_tune_socket(cl->fd);
+int net_listen(const char *bindaddr, int32_t port, int32_t backlog, bool reuseport)
+{
+	struct sockaddr_in sa;
+	int one = 1;
+	int fd  = (int)socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) return -1;
+
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, SO_CAST(&one), sizeof(one));
+#ifdef SO_REUSEPORT
+	if (reuseport && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, SO_CAST(&one), sizeof(one)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+#else
+	(void)reuseport;
+#endif
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family      = AF_INET;
+	sa.sin_addr.s_addr = INADDR_ANY;
+	if (bindaddr && bindaddr[0])
+		inet_pton(AF_INET, bindaddr, &sa.sin_addr);
+	sa.sin_port = htons((uint16_t)port);
+
+	if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd, backlog) < 0)
+	{
+		int e = errno;
+		close(fd);
+		errno = e;
+		return -1;
+	}
+	net_set_blocking(fd, false);
+	return fd;
+}
+
+int32_t nc_init(S_CLIENT *cl, const uint8_t *des_key14)
+{
+	uint8_t rnd[14], spread[16];
 
 	csprng(rnd, 14);
-	if (net_send_all(cl->fd, rnd, 14) != 14)
+	if (conn_write(cl->conn, rnd, 14) != 14)
 	{
 		secure_zero(rnd, sizeof(rnd));
-		return;
+		return -1;
 	}
 
 	memcpy(cl->session_key, des_key14, 14);
@@ -80,27 +140,21 @@ void nc_init(S_CLIENT *cl, const uint8_t *des_key14, int32_t timeout)
 		for (i = 0; i < 14; i++) rnd[i] ^= des_key14[i];
 	}
 	crypt_key_spread(rnd, spread);
-	memcpy(cl->key1, spread,     8);
-	memcpy(cl->key2, spread + 8, 8);
+	crypt_ede2_setkey(&cl->ks, spread);
 
 	secure_zero(rnd,    sizeof(rnd));
 	secure_zero(spread, sizeof(spread));
+	return 0;
 }
 
-int32_t nc_recv(S_CLIENT *cl, uint8_t *data,
-                uint16_t *sid, uint16_t *mid,
-                uint32_t *pid, uint16_t *caid_hdr)
+int32_t nc_decode(S_CLIENT *cl, uint8_t *buf, uint16_t total_len, uint8_t *data,
+                  uint16_t *sid, uint16_t *mid,
+                  uint32_t *pid, uint16_t *caid_hdr)
 {
-	uint8_t  lenbuf[2];
-	uint8_t *buf = cl->recv_buf;
-	uint8_t  iv[8], key16[16];
-	uint16_t total_len, payload_len;
+	uint8_t  iv[8];
+	uint16_t payload_len;
 	uint32_t rlen;
 
-	if (net_recv_all(cl->fd, lenbuf, 2) != 2) return -1;
-	total_len = be16(lenbuf);
-	if (total_len == 0 || total_len > NC_MSG_MAX) return -1;
-	if (net_recv_all(cl->fd, buf, total_len) != (int32_t)total_len) return -1;
 	if (total_len < 8) return -1;
 
 	payload_len = total_len - 8;
@@ -111,11 +165,8 @@ int32_t nc_recv(S_CLIENT *cl, uint8_t *data,
 	memcpy(iv, buf + payload_len, 8);
 	tcmg_dump_dbg(D_NEWCAMD, iv, 8, "%s [newcamd/mgcamd] recv IV", cl->ip);
 
-	memcpy(key16,     cl->key1, 8);
-	memcpy(key16 + 8, cl->key2, 8);
-	crypt_ede2_cbc(key16, iv, buf, buf, payload_len, false);
-	secure_zero(key16, sizeof(key16));
-	secure_zero(iv,    sizeof(iv));
+	crypt_ede2_cbc_ks(&cl->ks, iv, buf, buf, payload_len, false);
+	secure_zero(iv, sizeof(iv));
 
 	if (nc_xor(buf, payload_len)) return -1;
 
@@ -146,7 +197,7 @@ int32_t nc_recv(S_CLIENT *cl, uint8_t *data,
 static int32_t nc_finalize_send(S_CLIENT *cl, uint32_t blen)
 {
 	uint8_t *buf = cl->send_buf;
-	uint8_t  pad[8], iv[8], key16[16];
+	uint8_t  pad[8], iv[8];
 	uint32_t plen;
 
 	plen = (8 - ((blen - 1) % 8)) % 8;
@@ -160,17 +211,14 @@ static int32_t nc_finalize_send(S_CLIENT *cl, uint32_t blen)
 	csprng(iv, 8);
 	memcpy(buf + blen, iv, 8);
 
-	memcpy(key16,     cl->key1, 8);
-	memcpy(key16 + 8, cl->key2, 8);
-	crypt_ede2_cbc(key16, iv, buf + 2, buf + 2, blen - 2, true);
-	secure_zero(key16, sizeof(key16));
-	secure_zero(iv,    sizeof(iv));
+	crypt_ede2_cbc_ks(&cl->ks, iv, buf + 2, buf + 2, blen - 2, true);
+	secure_zero(iv, sizeof(iv));
 
 	blen += 8;
 	wr_be16(buf, (uint16_t)(blen - 2));
 	tcmg_dump_dbg(D_WIRE, buf, (int32_t)blen,
 	              "%s [newcamd/mgcamd] send raw encrypted", cl->ip);
-	return net_send_all(cl->fd, buf, (int32_t)blen);
+	return conn_write(cl->conn, buf, (int32_t)blen);
 }
 
 int32_t nc_send(S_CLIENT *cl, const uint8_t *data, int32_t dlen,
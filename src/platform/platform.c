@@ -1,6 +1,10 @@
 #define MODULE_LOG_PREFIX "platform"
 #include "../../globals.h"
 
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+
 void tcmg_mkdir(const char *path)
 {
 #ifdef TCMG_OS_WINDOWS
@@ -98,6 +102,21 @@ int tcmg_daemonise(void)
 #endif
 }
 
+void tcmg_pin_thread(int32_t slot)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu <= 1) return;
+    CPU_ZERO(&set);
+    CPU_SET((int)(slot % ncpu), &set);
+    if (sched_setaffinity(0, sizeof(set), &set) < 0)
+        tcmg_log_dbg(D_CONN, "sched_setaffinity(cpu=%ld) failed errno=%d", slot % ncpu, errno);
+#else
+    (void)slot;
+#endif
+}
+
 void tcmg_exec_restart(char **argv)
 {
 #ifdef TCMG_OS_WINDOWS
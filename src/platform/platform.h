@@ -28,6 +28,7 @@ static inline int32_t tcmg_elapsed_ms(int64_t t0_ms)
 
 void tcmg_setup_signals(_Atomic int32_t *running);
 int  tcmg_daemonise(void);
+void tcmg_pin_thread(int32_t slot);
 void tcmg_exec_restart(char **argv);
 
 #endif
@@ -4,41 +4,9 @@
 #include "../client/client.h"
 
 static _Atomic int32_t   s_cccam_running = 0;
-static pthread_t         s_cccam_thread;
-static int               s_cccam_srv_fd  = -1;
-
-
-static void cc_rc4_init(S_CC_CRYPT *b, const uint8_t *key, int klen)
-{
-    uint8_t j=0,tmp; int i;
-    for(i=0;i<256;i++) b->keytable[i]=(uint8_t)i;
-    for(i=0;i<256;i++){
-        j+=key[i%klen]+b->keytable[i];
-        tmp=b->keytable[i];b->keytable[i]=b->keytable[j];b->keytable[j]=tmp;}
-    b->state=key[0];b->counter=0;b->sum=0;
-}
-static void cc_decrypt(S_CC_CRYPT *b, uint8_t *data, int len)
-{
-    uint8_t z,tmp; int i;
-    for(i=0;i<len;i++){
-        b->counter++;b->sum+=b->keytable[b->counter];
-        tmp=b->keytable[b->counter];
-        b->keytable[b->counter]=b->keytable[b->sum];b->keytable[b->sum]=tmp;
-        z=data[i];
-        data[i]=z^b->keytable[(b->keytable[b->counter]+b->keytable[b->sum])&0xFF]^b->state;
-        z=data[i];b->state^=z;}
-}
-static void cc_encrypt(S_CC_CRYPT *b, uint8_t *data, int len)
-{
-    uint8_t z,tmp; int i;
-    for(i=0;i<len;i++){
-        b->counter++;b->sum+=b->keytable[b->counter];
-        tmp=b->keytable[b->counter];
-        b->keytable[b->counter]=b->keytable[b->sum];b->keytable[b->sum]=tmp;
-        z=data[i];
-        data[i]=z^b->keytable[(b->keytable[b->counter]+b->keytable[b->sum])&0xFF]^b->state;
-        b->state^=z;}
-}
+static pthread_t         s_cccam_thread[ACCEPT_THREADS_MAX];
+static int               s_cccam_srv_fd[ACCEPT_THREADS_MAX];
+static int32_t           s_cccam_nacc    = 0;
 
 static void cc_seed_xor(uint8_t *buf)
 {
@@ -53,12 +21,12 @@ static void cc_derive_keys(S_CCCAM_CLIENT *cc, const uint8_t *seed)
     memcpy(xseed, seed, 16);
     cc_seed_xor(xseed);
     sha1_hash(xseed, 16, hash);
-    cc_rc4_init(&cc->send_block, hash, 20);
+    crypt_cc_init(&cc->send_block, hash, 20);
     memcpy(dec_seed, xseed, 16);
-    cc_decrypt(&cc->send_block, dec_seed, 16);
-    cc_rc4_init(&cc->recv_block, dec_seed, 16);
+    crypt_cc_decrypt(&cc->send_block, dec_seed, 16);
+    crypt_cc_init(&cc->recv_block, dec_seed, 16);
     memcpy(hash_buf, hash, 20);
-    cc_decrypt(&cc->recv_block, hash_buf, 20);
+    crypt_cc_decrypt(&cc->recv_block, hash_buf, 20);
     secure_zero(xseed,    sizeof(xseed));
     secure_zero(hash,     sizeof(hash));
     secure_zero(hash_buf, sizeof(hash_buf));
@@ -75,24 +43,8 @@ static int cc_send_msg(S_CCCAM_CLIENT *cc, uint8_t cmd,
     buf[2]=(uint8_t)(plen>>8);
     buf[3]=(uint8_t)(plen&0xFF);
     if(plen) memcpy(buf+4,payload,plen);
-    cc_encrypt(&cc->send_block,buf,4+(int)plen);
-    return net_send_all(cc->fd,buf,4+(int)plen);
-}
-
-static int cc_recv_msg(S_CCCAM_CLIENT *cc, uint8_t *seq_out, uint8_t *cmd,
-                       uint8_t *buf, uint16_t *plen)
-{
-    uint8_t hdr[4]; uint16_t len;
-    if(net_recv_all(cc->fd,hdr,4)!=4) return -1;
-    cc_decrypt(&cc->recv_block,hdr,4);
-    *seq_out=hdr[0]; *cmd=hdr[1];
-    len=((uint16_t)hdr[2]<<8)|hdr[3];
-    if(len>CCCAM_MSG_MAX) return -1;
-    *plen=len;
-    if(len==0) return 0;
-    if(net_recv_all(cc->fd,buf,(int)len)!=(int)len) return -1;
-    cc_decrypt(&cc->recv_block,buf,(int)len);
-    return 0;
+    crypt_cc_encrypt(&cc->send_block,buf,4+(int)plen);
+    return conn_write(cc->conn,buf,4+(int)plen);
 }
 
 static void cc_cw_crypt(S_CCCAM_CLIENT *cc, uint8_t *cw, uint32_t card_id)
@@ -174,18 +126,114 @@ static void cc_send_cards(S_CCCAM_CLIENT *cc, const S_ACCOUNT *acc)
     tcmg_log_dbg(D_CCCAM, "sent %d card(s) to user='%s'", total, acc->user);
 }
 
+typedef struct {
+    S_JOB     job;
+    S_ECM_CTX ctx;
+    uint16_t  caid, sid;
+    uint32_t  card_id;
+    uint8_t   ecm_len, src;
+    int32_t   res;
+    int64_t   t0_ms;
+    uint8_t   md5[16];
+    uint8_t   cw[CW_LEN];
+    uint8_t   ecm[255];
+} S_CC_JOB;
+
+static void cc_ecm_result(S_CCCAM_CLIENT *cc, S_CLIENT *cl, uint16_t caid, uint16_t sid,
+                          uint32_t card_id, uint8_t ecm_len, int32_t res, uint8_t src,
+                          const uint8_t *cw, int64_t t0_ms)
+{
+    uint8_t resp[16];
+    long    ms;
+
+    ms  = src == CW_SRC_CACHE || src == CW_SRC_L1 ? 0 : (long)tcmg_elapsed_ms(t0_ms);
+    if(src!=CW_SRC_EMU)
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM %s user='%s' caid=%04X sid=%04X",
+                     cl->ip, src == CW_SRC_L1    ? "L1 cache HIT" :
+                             src == CW_SRC_CACHE ? "cache HIT" :
+                             src == CW_SRC_NEGATIVE ? "negative cache HIT" :
+                             src == CW_SRC_EXPIRED  ? "deadline missed" : "coalesced",
+                     cl->user, caid, sid);
+
+    if(res==EMU_OK){
+        memcpy(resp, cw, 16);
+        cc_cw_crypt(cc, resp, card_id);
+        cc_send_msg(cc,CCCAM_CMD_ECM_REQ,resp,16);
+        crypt_cc_encrypt(&cc->send_block,resp,16);
+        secure_zero(resp,sizeof(resp));
+        tcmg_dump_dbg(D_CCCAM, cw, CW_LEN,
+                      "%s [cccam] CW sent to user='%s' caid=%04X sid=%04X",
+                      cl->ip, cl->user, caid, sid);
+
+        pthread_mutex_lock(&cl->account->stat_mtx);
+        cl->account->cw_found++; cl->account->ecm_total++;
+        if (src == CW_SRC_L1) cl->account->cw_l1_hit++;
+        else if (src == CW_SRC_CACHE) cl->account->cw_l2_hit++;
+        cl->account->cw_time_total_ms += ms;
+        if (cl->account->cw_time_min_ms == 0 || ms < cl->account->cw_time_min_ms)
+            cl->account->cw_time_min_ms = ms;
+        if (ms > cl->account->cw_time_max_ms)
+            cl->account->cw_time_max_ms = ms;
+        pthread_mutex_unlock(&cl->account->stat_mtx);
+
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM result=FOUND user='%s' caid=%04X sid=%04X time=%ldms",
+                     cl->ip, cl->user, caid, sid, ms);
+    } else {
+        cc_send_msg(cc,CCCAM_CMD_ECM_NOK1,NULL,0);
+
+        pthread_mutex_lock(&cl->account->stat_mtx);
+        cl->account->cw_not++; cl->account->ecm_total++;
+        if (src == CW_SRC_NEGATIVE) cl->account->cw_neg++;
+        pthread_mutex_unlock(&cl->account->stat_mtx);
+
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM result=NOT_FOUND user='%s' caid=%04X sid=%04X emu_rc=%d time=%ldms",
+                     cl->ip, cl->user, caid, sid, res, ms);
+    }
+
+    log_cw_result(caid, sid, ecm_len, cw, res == EMU_OK, src, (int32_t)ms, cl->user);
+}
+
+static void cc_job_run(S_JOB *job)
+{
+    S_CC_JOB *j=(S_CC_JOB*)job;
+
+    log_set_user(j->ctx.user);
+    j->res=cw_cache_decode(j->md5, j->caid, j->sid, j->ecm, j->ecm_len,
+                           j->cw, &j->ctx, &j->src);
+}
+
+static void cc_job_pass(S_JOB *job)
+{
+    (void)job;
+}
+
+static void cc_job_done(S_JOB *job)
+{
+    S_CC_JOB     *j=(S_CC_JOB*)job;
+    S_CCCAM_CONN *x=(S_CCCAM_CONN*)job->conn;
+
+    if(job->expired){
+        j->res=EMU_KEY_NOT_FOUND;
+        j->src=CW_SRC_EXPIRED;
+    }
+    if(job->run==cc_job_run)
+        engine_ecm_latency(tcmg_elapsed_ms(j->t0_ms));
+    cc_ecm_result(&x->cc, &job->conn->cl, j->caid, j->sid, j->card_id, j->ecm_len,
+                  j->res, j->src, j->cw, j->t0_ms);
+}
+
 static void cc_handle_ecm(S_CCCAM_CLIENT *cc, S_CLIENT *cl,
                            uint8_t req_seq, const uint8_t *p, uint16_t plen)
 {
-    uint8_t  resp[16], cw[CW_LEN], ecm_md5[16];
+    uint8_t  cw[CW_LEN], ecm_md5[16];
     uint16_t caid, sid;
     uint32_t provid, card_id;
     uint8_t  ecm_len;
     int32_t  res;
-    bool     cache_hit;
+    uint8_t  src;
     S_ECM_CTX ctx;
+    S_CC_JOB *j;
     int64_t   t0_ms;
-    long      ms = 0;
 
     (void)req_seq;
 
@@ -221,346 +269,378 @@ static void cc_handle_ecm(S_CCCAM_CLIENT *cc, S_CLIENT *cl,
     tcmg_strlcpy(ctx.ip,cl->ip,MAXIPLEN);
     ctx.fd=cl->fd; ctx.caid=caid;
     ctx.thread_id=cl->thread_id; ctx.account=cl->account;
+    ctx.l1=conn_l1(cl->conn);
 
     crypt_md5_hash(p+13, ecm_len, ecm_md5);
     memset(cw,0,CW_LEN);
-    cache_hit = cw_cache_lookup(ecm_md5, cw);
-    if(cache_hit){
-        res = EMU_OK;
-        ms  = 0;
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM cache HIT user='%s' caid=%04X sid=%04X",
+    t0_ms = tcmg_mono_ms();
+    res = cw_cache_probe(ecm_md5, caid, sid, cw, &ctx, &src);
+    if(res!=CW_PROBE_MISS&&!conn_busy(cc->conn)){
+        cc_ecm_result(cc, cl, caid, sid, card_id, ecm_len, res, src, cw, t0_ms);
+        secure_zero(cw,sizeof(cw));
+        return;
+    }
+    if(res==CW_PROBE_MISS&&!engine_ecm_admit()){
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM shed: server overloaded user='%s' caid=%04X sid=%04X",
                      cl->ip, cl->user, caid, sid);
-    } else {
-        t0_ms = tcmg_mono_ms();
-        res=emu_process(caid,sid,p+13,ecm_len,cw,&ctx);
-        ms = (long)tcmg_elapsed_ms(t0_ms);
-        if(res==EMU_OK) cw_cache_store(ecm_md5, cw);
+        cc_send_msg(cc,CCCAM_CMD_ECM_NOK1,NULL,0); return;
     }
 
-    if(res==EMU_OK){
-        memcpy(resp, cw, 16);
-        cc_cw_crypt(cc, resp, card_id);
-        cc_send_msg(cc,CCCAM_CMD_ECM_REQ,resp,16);
-        cc_encrypt(&cc->send_block,resp,16);
-        tcmg_dump_dbg(D_CCCAM, cw, CW_LEN,
-                      "%s [cccam] CW sent to user='%s' caid=%04X sid=%04X",
-                      cl->ip, cl->user, caid, sid);
-
-        pthread_mutex_lock(&cl->account->stat_mtx);
-        cl->account->cw_found++; cl->account->ecm_total++;
-        cl->account->cw_time_total_ms += ms;
-        if (cl->account->cw_time_min_ms == 0 || ms < cl->account->cw_time_min_ms)
-            cl->account->cw_time_min_ms = ms;
-        if (ms > cl->account->cw_time_max_ms)
-            cl->account->cw_time_max_ms = ms;
-        pthread_mutex_unlock(&cl->account->stat_mtx);
-
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM result=FOUND user='%s' caid=%04X sid=%04X time=%ldms",
-                     cl->ip, cl->user, caid, sid, ms);
-    } else {
+    j=(S_CC_JOB*)tcmg_malloc(sizeof(*j));
+    if(!j){
         cc_send_msg(cc,CCCAM_CMD_ECM_NOK1,NULL,0);
-
-        pthread_mutex_lock(&cl->account->stat_mtx);
-        cl->account->cw_not++; cl->account->ecm_total++;
-        pthread_mutex_unlock(&cl->account->stat_mtx);
-
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM result=NOT_FOUND user='%s' caid=%04X sid=%04X emu_rc=%d time=%ldms",
-                     cl->ip, cl->user, caid, sid, res, ms);
+        secure_zero(cw,sizeof(cw));
+        return;
     }
-
-    log_cw_result(caid, sid, ecm_len, cw, res == EMU_OK, cache_hit, (int32_t)ms, cl->user);
+    j->job.conn=cl->conn;
+    j->job.account=cfg_account_ref(cl->account);
+    j->job.size=sizeof(*j);
+    j->job.run=res==CW_PROBE_MISS ? cc_job_run : cc_job_pass;
+    j->job.done=cc_job_done;
+    j->job.prio=cl->account->group;
+    j->job.deadline_ms=res==CW_PROBE_MISS ? t0_ms+g_cfg.ecm_budget_ms : 0;
+    j->ctx=ctx;
+    j->caid=caid; j->sid=sid; j->card_id=card_id;
+    j->ecm_len=ecm_len; j->res=res; j->src=src;
+    j->t0_ms=t0_ms;
+    memcpy(j->md5,ecm_md5,sizeof(j->md5));
+    memcpy(j->cw,cw,CW_LEN);
+    memcpy(j->ecm,p+13,ecm_len);
     secure_zero(cw,sizeof(cw));
+
+    if(!engine_job_submit(&j->job)){
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] ECM dropped: backlog full (%d) for user='%s'",
+                     cl->ip, ECM_BACKLOG_MAX, cl->user);
+        cc_send_msg(cc,CCCAM_CMD_ECM_NOK1,NULL,0);
+        cfg_account_release(j->job.account);
+        secure_zero(j,sizeof(*j));
+        free(j);
+    }
     (void)provid;
 }
 
-void *handle_cccam_client(void *arg)
+static int32_t cc_on_open(S_CONN *c)
 {
-    S_CONN_ARGS    *args=(S_CONN_ARGS*)arg;
-    S_CCCAM_CLIENT  cc;
-    S_CLIENT        cl;
-    uint8_t         seed[CCCAM_SEED_LEN];
-    uint8_t         cli_hash[CCCAM_HASH_LEN];
-    uint8_t         username[20];
-    uint8_t         ccstr_recv[6];
-    uint8_t         ack[20];
-    uint8_t         pwd_enc[256];
-    S_ACCOUNT      *acc;
-    char            user[CFGKEY_LEN];
-    uint8_t         cmd,req_seq;
-    uint8_t         payload[CCCAM_MSG_MAX];
-    uint16_t        plen;
-
-    memset(&cc,0,sizeof(cc)); memset(&cl,0,sizeof(cl));
-    cc.fd=args->fd; cl.fd=args->fd;
-    cl.thread_id=(uint32_t)(uintptr_t)pthread_self();
-    cl.connect_time=time(NULL); cl.last_ecm_time=time(NULL);
-    cl.is_mgcamd=0;
-    tcmg_strlcpy(cl.proto, "cccam", sizeof(cl.proto));
-    tcmg_strlcpy(cl.ip,args->ip,MAXIPLEN);
-    free(args);
-
-    log_set_type(LOG_TYPE_CLIENT);
-    client_register(&cl);
-    tcmg_log_dbg(D_CONN,"%s [cccam] new connection fd=%d tid=%u",
-                 cl.ip, cl.fd, cl.thread_id);
+    S_CCCAM_CONN *x=(S_CCCAM_CONN*)c;
+    uint8_t       seed[CCCAM_SEED_LEN];
 
-    net_set_timeout(cc.fd,g_cfg.sock_timeout);
-    net_tune_socket(cc.fd);
-
-    if(ban_is_banned(cl.ip)){
-        tcmg_log("%s [cccam] LOGIN failed: IP is banned", cl.ip);
-        goto cleanup;
+    x->cc.conn=c;
+    if(ban_is_banned(c->cl.ip)){
+        tcmg_log("%s [cccam] LOGIN failed: IP is banned", c->cl.ip);
+        return -1;
     }
 
     csprng(seed,CCCAM_SEED_LEN);
-    tcmg_log_dbg(D_CCCAM, "%s [cccam] sending %d-byte seed", cl.ip, CCCAM_SEED_LEN);
-    if(net_send_all(cc.fd,seed,CCCAM_SEED_LEN)!=CCCAM_SEED_LEN) goto cleanup;
+    tcmg_log_dbg(D_CCCAM, "%s [cccam] sending %d-byte seed", c->cl.ip, CCCAM_SEED_LEN);
+    if(conn_write(c,seed,CCCAM_SEED_LEN)!=CCCAM_SEED_LEN) return -1;
 
-    cc_derive_keys(&cc,seed);
+    cc_derive_keys(&x->cc,seed);
     secure_zero(seed,sizeof(seed));
-    tcmg_log_dbg(D_CCCAM, "%s [cccam] session keys derived", cl.ip);
+    tcmg_log_dbg(D_CCCAM, "%s [cccam] session keys derived", c->cl.ip);
 
-    if(net_recv_all(cc.fd,cli_hash,CCCAM_HASH_LEN)!=CCCAM_HASH_LEN) {
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] failed to receive client hash", cl.ip);
-        goto cleanup;
-    }
-    cc_decrypt(&cc.recv_block,cli_hash,CCCAM_HASH_LEN);
-    secure_zero(cli_hash,sizeof(cli_hash));
+    x->state=CCCAM_ST_HASH;
+    conn_expect(c,CCCAM_HASH_LEN);
+    return 0;
+}
 
-    if(net_recv_all(cc.fd,username,20)!=20) {
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] failed to receive username", cl.ip);
-        goto cleanup;
-    }
-    cc_decrypt(&cc.recv_block,username,20);
+static int32_t cc_login_user(S_CCCAM_CONN *x)
+{
+    S_CONN    *c=&x->conn;
+    uint8_t   *username=c->rbuf;
+    uint8_t    pwd_enc[256];
+    S_ACCOUNT *acc;
+
+    crypt_cc_decrypt(&x->cc.recv_block,username,20);
     username[19]='\0';
-    memset(user,0,sizeof(user));
-    tcmg_strlcpy(user,(char*)username,sizeof(user));
-    secure_zero(username,sizeof(username));
+    memset(x->user,0,sizeof(x->user));
+    tcmg_strlcpy(x->user,(char*)username,sizeof(x->user));
+    secure_zero(username,20);
 
-    tcmg_log_dbg(D_CCCAM, "%s [cccam] LOGIN attempt user='%s'", cl.ip, user);
+    tcmg_log_dbg(D_CCCAM, "%s [cccam] LOGIN attempt user='%s'", c->cl.ip, x->user);
 
     pthread_rwlock_rdlock(&g_cfg.acc_lock);
-    acc=cfg_find_account(user);
-    pthread_rwlock_unlock(&g_cfg.acc_lock);
-
+    acc=cfg_find_account(x->user);
     if(!acc){
-        tcmg_log("%s [cccam] LOGIN failed: unknown user '%s'", cl.ip, user);
-        ban_record_fail(cl.ip); goto cleanup;
+        pthread_rwlock_unlock(&g_cfg.acc_lock);
+        tcmg_log("%s [cccam] LOGIN failed: unknown user '%s'", c->cl.ip, x->user);
+        ban_record_fail(c->cl.ip); return -1;
     }
     if(!acc->enabled){
-        tcmg_log("%s [cccam] LOGIN failed: account disabled user='%s'", cl.ip, user);
-        goto cleanup;
+        pthread_rwlock_unlock(&g_cfg.acc_lock);
+        tcmg_log("%s [cccam] LOGIN failed: account disabled user='%s'", c->cl.ip, x->user);
+        return -1;
     }
 
     {
         size_t pwlen=strlen(acc->pass);
         if(pwlen>0&&pwlen<=255){
             memcpy(pwd_enc,acc->pass,pwlen);
-            cc_encrypt(&cc.recv_block,pwd_enc,(int)pwlen);
+            crypt_cc_encrypt(&x->cc.recv_block,pwd_enc,(int)pwlen);
             secure_zero(pwd_enc,pwlen);
         }
     }
+    pthread_rwlock_unlock(&g_cfg.acc_lock);
 
-    if(net_recv_all(cc.fd,ccstr_recv,6)!=6) {
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] failed to receive CCcam string user='%s'",
-                     cl.ip, user);
-        goto cleanup;
-    }
-    cc_decrypt(&cc.recv_block,ccstr_recv,6);
+    x->state=CCCAM_ST_PASS;
+    conn_expect(c,6);
+    return 0;
+}
 
+static int32_t cc_login_pass(S_CCCAM_CONN *x)
+{
+    S_CONN    *c=&x->conn;
+    S_CLIENT  *cl=&c->cl;
+    uint8_t   *ccstr_recv=c->rbuf;
+    uint8_t    ack[20];
+    S_ACCOUNT *acc;
+
+    crypt_cc_decrypt(&x->cc.recv_block,ccstr_recv,6);
     if(memcmp(ccstr_recv,"CCcam",5)!=0){
-        tcmg_log("%s [cccam] LOGIN failed: wrong password for user='%s'", cl.ip, user);
-        ban_record_fail(cl.ip); goto cleanup;
+        tcmg_log("%s [cccam] LOGIN failed: wrong password for user='%s'", cl->ip, x->user);
+        ban_record_fail(cl->ip); return -1;
     }
-    secure_zero(ccstr_recv,sizeof(ccstr_recv));
+    secure_zero(ccstr_recv,6);
 
     memset(ack,0,sizeof(ack));
     memcpy(ack,"CCcam",5);
-    cc_encrypt(&cc.send_block,ack,20);
-    if(net_send_all(cc.fd,ack,20)!=20) goto cleanup;
+    crypt_cc_encrypt(&x->cc.send_block,ack,20);
+    if(conn_write(c,ack,20)!=20) return -1;
     secure_zero(ack,sizeof(ack));
 
-    if(acc->max_connections>0){
-        pthread_rwlock_wrlock(&g_cfg.acc_lock);
-        bool over=((int32_t)acc->active>=acc->max_connections);
-        if(!over) atomic_fetch_add(&acc->active,1);
-        pthread_rwlock_unlock(&g_cfg.acc_lock);
-        if(over){
-            tcmg_log("%s [cccam] LOGIN failed: max_connections=%d reached for user='%s' active=%d",
-                     cl.ip, acc->max_connections, acc->user, (int)acc->active);
-            goto cleanup;
-        }
-    } else {
-        atomic_fetch_add(&acc->active,1);
+    acc=cfg_account_acquire(x->user);
+    if(!acc){
+        tcmg_log("%s [cccam] LOGIN failed: unknown user '%s'", cl->ip, x->user);
+        return -1;
     }
 
-    tcmg_strlcpy(cl.user,acc->user,CFGKEY_LEN);
-    cl.account=acc; cl.caid=acc->caid;
+    if(!cfg_account_admit(&acc)){
+        tcmg_log("%s [cccam] LOGIN failed: max_connections=%d reached for user='%s' active=%d",
+                 cl->ip, acc->max_connections, acc->user, (int)acc->active);
+        cfg_account_release(acc);
+        return -1;
+    }
+
+    client_set_user(cl,acc->user);
+    cl->account=acc; cl->caid=acc->caid;
 
     log_set_user(acc->user);
     atomic_store(&acc->last_seen, time(NULL));
     if(!acc->first_login) acc->first_login=time(NULL);
-    ban_record_ok(cl.ip);
+    ban_record_ok(cl->ip);
 
     {
         int card_count = acc->ncaids + (acc->caid ? 1 : 0);
         tcmg_log("%s [cccam] LOGIN ok user='%s' cards=%d max_conn=%d",
-                 cl.ip, acc->user, card_count, acc->max_connections);
-    }
-
-    cc_send_msg(&cc,CCCAM_CMD_CLI_DATA,NULL,0);
-    tcmg_log_dbg(D_CCCAM, "%s [cccam] CLI_DATA ack sent to user='%s'", cl.ip, acc->user);
-    cc_send_srv_data(&cc);
-    tcmg_log_dbg(D_CCCAM, "%s [cccam] SRV_DATA sent to user='%s'", cl.ip, acc->user);
-    cc_send_cards(&cc,acc);
-
-    while(g_running&&!cl.kill_flag){
-        if(acc->max_idle>0){
-            time_t idle=time(NULL)-cl.last_ecm_time;
-            if(idle>=acc->max_idle){
-                tcmg_log("%s [cccam] idle timeout %lds >= max_idle=%ds disconnecting user='%s'",
-                         cl.ip, (long)idle, acc->max_idle, cl.user);
-                break;
-            }
-        }
+                 cl->ip, acc->user, card_count, acc->max_connections);
+    }
 
-        if(cc_recv_msg(&cc,&req_seq,&cmd,payload,&plen)<0){
-            if (cl.user[0])
-                tcmg_log("%s [cccam] disconnected user='%s' ecm_total=%llu cw_found=%lld",
-                         cl.ip, cl.user,
-                         cl.account ? (unsigned long long)cl.account->ecm_total : 0ULL,
-                         cl.account ? (long long)cl.account->cw_found : 0LL);
-            else
-                tcmg_log_dbg(D_CONN, "%s [cccam] disconnected (no user)", cl.ip);
-            break;
-        }
+    cc_send_msg(&x->cc,CCCAM_CMD_CLI_DATA,NULL,0);
+    tcmg_log_dbg(D_CCCAM, "%s [cccam] CLI_DATA ack sent to user='%s'", cl->ip, acc->user);
+    cc_send_srv_data(&x->cc);
+    tcmg_log_dbg(D_CCCAM, "%s [cccam] SRV_DATA sent to user='%s'", cl->ip, acc->user);
+    cc_send_cards(&x->cc,acc);
+
+    x->state=CCCAM_ST_MSG;
+    conn_expect(c,4);
+    return 0;
+}
 
-        tcmg_log_dbg(D_CCCAM, "%s [cccam] recv cmd=0x%02X plen=%u seq=%u",
-                     cl.ip, cmd, plen, req_seq);
-
-        if(cmd==CCCAM_CMD_ECM_REQ){
-            cc_handle_ecm(&cc,&cl,req_seq,payload,plen);
-        } else if(cmd==CCCAM_CMD_KEEPALIVE){
-            tcmg_log_dbg(D_CCCAM, "%s [cccam] KEEPALIVE user='%s'", cl.ip, cl.user);
-            cc_send_msg(&cc,CCCAM_CMD_KEEPALIVE,NULL,0);
-        } else if(cmd==CCCAM_CMD_CLI_DATA){
-            tcmg_log_dbg(D_CCCAM, "%s [cccam] CLI_DATA user='%s' plen=%u", cl.ip, cl.user, plen);
-            if(plen>=28) memcpy(cc.peer_node_id, payload+20, 8);
-            cc_send_msg(&cc,CCCAM_CMD_CLI_DATA,NULL,0);
-        } else if(cmd==CCCAM_CMD_EMM_REQ){
-            tcmg_log_dbg(D_CCCAM, "%s [cccam] EMM_REQ user='%s' plen=%u (ignored)", cl.ip, cl.user, plen);
-            cc_send_msg(&cc,CCCAM_CMD_EMM_REQ,NULL,0);
-        } else if(cmd==0x0C||cmd==0x0D||cmd==0x0E){
-            tcmg_log_dbg(D_CCCAM, "%s [cccam] cmd=0x%02X user='%s' plen=%u (echo)", cl.ip, cmd, cl.user, plen);
-            cc_send_msg(&cc,cmd,NULL,0);
-        } else {
-            tcmg_log_dbg(D_CCCAM, "%s [cccam] unknown cmd=0x%02X plen=%u -- ignored",
-                         cl.ip, cmd, plen);
+static int32_t cc_on_msg(S_CCCAM_CONN *x)
+{
+    S_CONN   *c=&x->conn;
+    S_CLIENT *cl=&c->cl;
+    uint8_t  *payload=c->rbuf+4;
+    uint8_t   cmd,req_seq;
+    uint16_t  plen;
+
+    if(c->want==4){
+        crypt_cc_decrypt(&x->cc.recv_block,c->rbuf,4);
+        plen=((uint16_t)c->rbuf[2]<<8)|c->rbuf[3];
+        if(plen>CCCAM_MSG_MAX){
+            tcmg_log_dbg(D_CCCAM, "%s [cccam] bad message length=%u -- disconnecting", cl->ip, plen);
+            return -1;
         }
+        if(plen){ c->want=4+(uint32_t)plen; return 0; }
+    } else {
+        crypt_cc_decrypt(&x->cc.recv_block,payload,(int)(c->rlen-4));
+    }
+    req_seq=c->rbuf[0]; cmd=c->rbuf[1];
+    plen=(uint16_t)(c->rlen-4);
+
+    tcmg_log_dbg(D_CCCAM, "%s [cccam] recv cmd=0x%02X plen=%u seq=%u",
+                 cl->ip, cmd, plen, req_seq);
+
+    if(cmd==CCCAM_CMD_ECM_REQ){
+        cc_handle_ecm(&x->cc,cl,req_seq,payload,plen);
+    } else if(cmd==CCCAM_CMD_KEEPALIVE){
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] KEEPALIVE user='%s'", cl->ip, cl->user);
+        cc_send_msg(&x->cc,CCCAM_CMD_KEEPALIVE,NULL,0);
+    } else if(cmd==CCCAM_CMD_CLI_DATA){
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] CLI_DATA user='%s' plen=%u", cl->ip, cl->user, plen);
+        if(plen>=28) memcpy(x->cc.peer_node_id, payload+20, 8);
+        cc_send_msg(&x->cc,CCCAM_CMD_CLI_DATA,NULL,0);
+    } else if(cmd==CCCAM_CMD_EMM_REQ){
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] EMM_REQ user='%s' plen=%u (ignored)", cl->ip, cl->user, plen);
+        cc_send_msg(&x->cc,CCCAM_CMD_EMM_REQ,NULL,0);
+    } else if(cmd==0x0C||cmd==0x0D||cmd==0x0E){
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] cmd=0x%02X user='%s' plen=%u (echo)", cl->ip, cmd, cl->user, plen);
+        cc_send_msg(&x->cc,cmd,NULL,0);
+    } else {
+        tcmg_log_dbg(D_CCCAM, "%s [cccam] unknown cmd=0x%02X plen=%u -- ignored",
+                     cl->ip, cmd, plen);
     }
 
-    atomic_fetch_sub(&acc->active,1);
+    conn_expect(c,4);
+    return 0;
+}
 
-cleanup:
-    client_unregister(&cl);
-    tcmg_log_dbg(D_CONN, "%s [cccam] connection closed fd=%d tid=%u", cl.ip, cl.fd, cl.thread_id);
-    close(cc.fd);
-    atomic_fetch_sub(&g_active_conns,1);
-    return NULL;
+static int32_t cc_on_data(S_CONN *c)
+{
+    S_CCCAM_CONN *x=(S_CCCAM_CONN*)c;
+
+    switch(x->state){
+    case CCCAM_ST_HASH:
+        crypt_cc_decrypt(&x->cc.recv_block,c->rbuf,CCCAM_HASH_LEN);
+        secure_zero(c->rbuf,CCCAM_HASH_LEN);
+        x->state=CCCAM_ST_USER;
+        conn_expect(c,20);
+        return 0;
+    case CCCAM_ST_USER:
+        return cc_login_user(x);
+    case CCCAM_ST_PASS:
+        return cc_login_pass(x);
+    default:
+        return cc_on_msg(x);
+    }
 }
 
-static void *cccam_listen_thread(void *arg)
+static int32_t cc_on_tick(S_CONN *c)
 {
-    struct sockaddr_in ca; socklen_t clen;
-    pthread_attr_t attr;
-    (void)arg;
+    S_CLIENT *cl=&c->cl;
+
+    if(cl->account&&cl->account->max_idle>0){
+        time_t idle=time(NULL)-cl->last_ecm_time;
+        if(idle>=cl->account->max_idle){
+            tcmg_log("%s [cccam] idle timeout %lds >= max_idle=%ds disconnecting user='%s'",
+                     cl->ip, (long)idle, cl->account->max_idle, cl->user);
+            return -1;
+        }
+    }
+    return 0;
+}
 
-    log_set_type(LOG_TYPE_CLIENT);
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
-    pthread_attr_setstacksize(&attr,256*1024);
+static void cc_on_close(S_CONN *c, bool peer)
+{
+    S_CCCAM_CONN *x=(S_CCCAM_CONN*)c;
+    S_CLIENT     *cl=&c->cl;
+
+    if(peer){
+        if(cl->user[0])
+            tcmg_log("%s [cccam] disconnected user='%s' ecm_total=%llu cw_found=%lld",
+                     cl->ip, cl->user,
+                     cl->account ? (unsigned long long)cl->account->ecm_total : 0ULL,
+                     cl->account ? (long long)cl->account->cw_found : 0LL);
+        else if(x->state!=CCCAM_ST_MSG)
+            tcmg_log_dbg(D_CCCAM, "%s [cccam] disconnected during login state=%u", cl->ip, x->state);
+    }
+    secure_zero(&x->cc,sizeof(x->cc));
+}
 
-    while(s_cccam_running&&g_running){
-        fd_set rfds; FD_ZERO(&rfds); FD_SET(s_cccam_srv_fd,&rfds);
-        struct timeval tv={1,0};
-        if(select(s_cccam_srv_fd+1,&rfds,NULL,NULL,&tv)<=0) continue;
-
-        clen=sizeof(ca);
-        int cfd=(int)accept(s_cccam_srv_fd,(struct sockaddr*)&ca,&clen);
-        if(cfd<0){
-            if(s_cccam_running)
-                tcmg_log_dbg(D_CONN, "[cccam] accept() failed errno=%d (%s)",
-                             errno, strerror(errno));
-            continue;
-        }
+static const S_CONN_OPS s_cccam_ops = {
+    "cccam", sizeof(S_CCCAM_CONN),
+    cc_on_open, cc_on_data, cc_on_tick, cc_on_close, 1
+};
 
-        int active = atomic_fetch_add(&g_active_conns,1);
-        if(active>=MAX_CONNS){
-            atomic_fetch_sub(&g_active_conns,1); close(cfd);
-            tcmg_log("[cccam] MAX_CONNS=%d reached -- connection rejected active=%d",
-                     MAX_CONNS, active);
-            continue;
-        }
+static bool cccam_accept_one(int srv_fd)
+{
+    struct sockaddr_in ca; socklen_t clen=sizeof(ca);
+    char ip[MAXIPLEN];
+
+    int cfd=(int)accept(srv_fd,(struct sockaddr*)&ca,&clen);
+    if(cfd<0){
+        if(s_cccam_running&&errno!=EAGAIN&&errno!=EWOULDBLOCK)
+            tcmg_log_dbg(D_CONN, "[cccam] accept() failed errno=%d (%s)",
+                         errno, strerror(errno));
+        return false;
+    }
 
-        S_CONN_ARGS *a=(S_CONN_ARGS*)tcmg_malloc(sizeof(S_CONN_ARGS));
-        if(!a){
-            atomic_fetch_sub(&g_active_conns,1); close(cfd);
-            tcmg_log("[cccam] out of memory -- connection rejected active=%d", active);
-            continue;
-        }
-        a->fd=cfd;
-        inet_ntop(AF_INET,&ca.sin_addr,a->ip,MAXIPLEN);
-        a->ip[MAXIPLEN-1]='\0';
+    int active = atomic_fetch_add(&g_active_conns,1);
+    if(active>=g_cfg.max_clients){
+        atomic_fetch_sub(&g_active_conns,1); close(cfd);
+        tcmg_log("[cccam] MAX_CLIENTS=%d reached -- connection rejected active=%d",
+                 g_cfg.max_clients, active);
+        return true;
+    }
 
-        tcmg_log_dbg(D_CONN, "%s [cccam] accepted connection fd=%d active=%d",
-                     a->ip, cfd, active+1);
+    inet_ntop(AF_INET,&ca.sin_addr,ip,MAXIPLEN);
+    ip[MAXIPLEN-1]='\0';
 
-        pthread_t tid;
-        if(pthread_create(&tid,&attr,handle_cccam_client,a)!=0){
-            tcmg_log("[cccam] pthread_create failed errno=%d (%s)", errno, strerror(errno));
-            atomic_fetch_sub(&g_active_conns,1); close(cfd); free(a);
-        }
+    tcmg_log_dbg(D_CONN, "%s [cccam] accepted connection fd=%d active=%d",
+                 ip, cfd, active+1);
+
+    if(!engine_attach(cfd,ip,&s_cccam_ops)){
+        tcmg_log("%s [cccam] connection rejected -- cannot attach active=%d", ip, active);
+        atomic_fetch_sub(&g_active_conns,1); close(cfd);
     }
-    pthread_attr_destroy(&attr);
-    tcmg_log_dbg(D_CONN, "%s", "[cccam] accept thread exiting");
+    return true;
+}
+
+static void *cccam_listen_thread(void *arg)
+{
+    int32_t slot=(int32_t)(intptr_t)arg;
+    int srv_fd=s_cccam_srv_fd[slot];
+
+    log_set_type(LOG_TYPE_CLIENT);
+    if(s_cccam_nacc>1) tcmg_pin_thread(slot);
+
+    while(s_cccam_running&&g_running){
+        if(tcmg_poll_in(srv_fd,1000)<=0) continue;
+        for(int32_t i=0;i<ACCEPT_BURST&&s_cccam_running;i++)
+            if(!cccam_accept_one(srv_fd)) break;
+    }
+    tcmg_log_dbg(D_CONN, "[cccam] accept thread %d exiting", slot);
     return NULL;
 }
 
+static void cccam_close_listeners(void)
+{
+    for(int32_t i=0;i<s_cccam_nacc;i++){
+        if(s_cccam_srv_fd[i]>=0) close(s_cccam_srv_fd[i]);
+        s_cccam_srv_fd[i]=-1;
+    }
+    s_cccam_nacc=0;
+}
+
 int32_t cccam_start(void)
 {
-    struct sockaddr_in sa; int opt=1;
+    int32_t n;
     if(!g_cfg.cccam_port) {
         tcmg_log_dbg(D_CCCAM, "%s", "disabled (port=0)");
         return -1;
     }
 
-    s_cccam_srv_fd=(int)socket(AF_INET,SOCK_STREAM,0);
-    if(s_cccam_srv_fd<0){
-        tcmg_log("[cccam] socket() failed errno=%d (%s)", errno, strerror(errno));
-        return -1;
-    }
-
-    setsockopt(s_cccam_srv_fd,SOL_SOCKET,SO_REUSEADDR,SO_CAST(&opt),sizeof(opt));
-    memset(&sa,0,sizeof(sa));
-    sa.sin_family=AF_INET; sa.sin_addr.s_addr=INADDR_ANY;
-    sa.sin_port=htons((uint16_t)g_cfg.cccam_port);
-
-    if(bind(s_cccam_srv_fd,(struct sockaddr*)&sa,sizeof(sa))<0){
-        tcmg_log("[cccam] bind() failed port=%d errno=%d (%s)",
-                 g_cfg.cccam_port, errno, strerror(errno));
-        close(s_cccam_srv_fd);s_cccam_srv_fd=-1;return -1;
-    }
-    if(listen(s_cccam_srv_fd,64)<0){
-        tcmg_log("[cccam] listen() failed errno=%d (%s)", errno, strerror(errno));
-        close(s_cccam_srv_fd);s_cccam_srv_fd=-1;return -1;
+    s_cccam_nacc=net_acceptors();
+    for(n=0;n<s_cccam_nacc;n++){
+        s_cccam_srv_fd[n]=net_listen(NULL,g_cfg.cccam_port,64,s_cccam_nacc>1);
+        if(s_cccam_srv_fd[n]<0){
+            tcmg_log("[cccam] listen failed port=%d errno=%d (%s)",
+                     g_cfg.cccam_port, errno, strerror(errno));
+            s_cccam_nacc=n; cccam_close_listeners(); return -1;
+        }
     }
 
     s_cccam_running=1;
-    if(pthread_create(&s_cccam_thread,NULL,cccam_listen_thread,NULL)!=0){
-        tcmg_log("[cccam] failed to start listener errno=%d (%s)", errno, strerror(errno));
-        s_cccam_running=0;close(s_cccam_srv_fd);s_cccam_srv_fd=-1;return -1;
+    for(n=0;n<s_cccam_nacc;n++){
+        if(pthread_create(&s_cccam_thread[n],NULL,cccam_listen_thread,(void*)(intptr_t)n)!=0){
+            tcmg_log("[cccam] failed to start listener errno=%d (%s)", errno, strerror(errno));
+            break;
+        }
     }
-    tcmg_log("listening on port=%d", g_cfg.cccam_port);
+    if(n==0){ s_cccam_running=0; cccam_close_listeners(); return -1; }
+    for(int32_t i=n;i<s_cccam_nacc;i++){ close(s_cccam_srv_fd[i]); s_cccam_srv_fd[i]=-1; }
+    s_cccam_nacc=n;
+
+    tcmg_log("listening on port=%d acceptors=%d", g_cfg.cccam_port, s_cccam_nacc);
     return 0;
 }
 
@@ -569,7 +649,7 @@ void cccam_stop(void)
     if(!s_cccam_running) return;
     tcmg_log_dbg(D_CCCAM, "%s", "[cccam] stopping...");
     s_cccam_running=0;
-    if(s_cccam_srv_fd>=0){close(s_cccam_srv_fd);s_cccam_srv_fd=-1;}
-    pthread_join(s_cccam_thread,NULL);
+    for(int32_t i=0;i<s_cccam_nacc;i++) pthread_join(s_cccam_thread[i],NULL);
+    cccam_close_listeners();
     tcmg_log("%s", "[cccam] stopped");
 }
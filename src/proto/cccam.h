@@ -15,15 +15,13 @@
 #define CCCAM_CMD_ECM_NOK1   0xFE
 #define CCCAM_CMD_ECM_NOK2   0xFF
 
-typedef struct {
-    uint8_t keytable[256];
-    uint8_t state;
-    uint8_t counter;
-    uint8_t sum;
-} S_CC_CRYPT;
+#define CCCAM_ST_HASH        0
+#define CCCAM_ST_USER        1
+#define CCCAM_ST_PASS        2
+#define CCCAM_ST_MSG         3
 
 typedef struct {
-    int        fd;
+    S_CONN    *conn;
     char       ip[MAXIPLEN];
     uint8_t    seq;
     uint8_t    node_id[8];
@@ -32,8 +30,14 @@ typedef struct {
     S_CC_CRYPT recv_block;
 } S_CCCAM_CLIENT;
 
+typedef struct {
+    S_CONN         conn;
+    S_CCCAM_CLIENT cc;
+    uint8_t        state;
+    char           user[CFGKEY_LEN];
+} S_CCCAM_CONN;
+
 int32_t cccam_start(void);
 void    cccam_stop(void);
-void   *handle_cccam_client(void *arg);
 
 #endif
@@ -4,8 +4,9 @@
 #include "../client/client.h"
 
 static _Atomic int32_t   s_ncd_running = 0;
-static pthread_t         s_ncd_thread;
-static int               s_ncd_srv_fd  = -1;
+static pthread_t         s_ncd_thread[ACCEPT_THREADS_MAX];
+static int               s_ncd_srv_fd[ACCEPT_THREADS_MAX];
+static int32_t           s_ncd_nacc    = 0;
 
 static void ncd_nak(S_CLIENT *cl, uint16_t sid, uint16_t mid, uint32_t pid)
 {
@@ -102,22 +103,20 @@ static bool ncd_handle_login(S_CLIENT *cl,
 		return false;
 	}
 
-	pthread_rwlock_rdlock(&g_cfg.acc_lock);
-	acc = cfg_find_account(user);
-	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	acc = cfg_account_acquire(user);
 
 	if (!acc)
 	{
 		ncd_nak(cl, sid, mid, pid);
 		tcmg_log("%s LOGIN failed: unknown user '%s'", ip, user);
 		ban_record_fail(ip);
-		return false;
+		goto fail;
 	}
 	if (!acc->enabled)
 	{
 		ncd_nak(cl, sid, mid, pid);
 		tcmg_log("%s LOGIN failed: account disabled user='%s'", ip, user);
-		return false;
+		goto fail;
 	}
 
 	if (acc->nwhitelist > 0)
@@ -131,17 +130,21 @@ static bool ncd_handle_login(S_CLIENT *cl,
 			ncd_nak(cl, sid, mid, pid);
 			tcmg_log("%s LOGIN failed: IP not in whitelist for user='%s' (whitelist has %d entries)",
 			         ip, user, acc->nwhitelist);
-			return false;
+			goto fail;
 		}
 	}
 
-	if (!crypt_md5_crypt(acc->pass, hash, expected, sizeof(expected)) ||
-	    !ct_streq(expected, hash))
+	if (!auth_cache_check(acc->user, acc->pass, hash))
 	{
-		ncd_nak(cl, sid, mid, pid);
-		tcmg_log("%s LOGIN failed: wrong password for user='%s'", ip, user);
-		ban_record_fail(ip);
-		return false;
+		if (!crypt_md5_crypt(acc->pass, hash, expected, sizeof(expected)) ||
+		    !ct_streq(expected, hash))
+		{
+			ncd_nak(cl, sid, mid, pid);
+			tcmg_log("%s LOGIN failed: wrong password for user='%s'", ip, user);
+			ban_record_fail(ip);
+			goto fail;
+		}
+		auth_cache_store(acc->user, acc->pass, hash);
 	}
 
 	if (acc->expirationdate > 0 && time(NULL) > acc->expirationdate)
@@ -149,27 +152,15 @@ static bool ncd_handle_login(S_CLIENT *cl,
 		ncd_nak(cl, sid, mid, pid);
 		tcmg_log("%s LOGIN failed: account expired user='%s' expired=%ld",
 		         ip, acc->user, (long)acc->expirationdate);
-		return false;
+		goto fail;
 	}
 
-	if (acc->max_connections > 0)
-	{
-		pthread_rwlock_wrlock(&g_cfg.acc_lock);
-		bool over = ((int32_t)acc->active >= acc->max_connections);
-		if (!over)
-			atomic_fetch_add(&acc->active, 1);
-		pthread_rwlock_unlock(&g_cfg.acc_lock);
-		if (over)
-		{
-			ncd_nak(cl, sid, mid, pid);
-			tcmg_log("%s LOGIN failed: max_connections=%d reached for user='%s' active=%d",
-			         ip, acc->max_connections, acc->user, (int)acc->active);
-			return false;
-		}
-	}
-	else
+	if (!cfg_account_admit(&acc))
 	{
-		atomic_fetch_add(&acc->active, 1);
+		ncd_nak(cl, sid, mid, pid);
+		tcmg_log("%s LOGIN failed: max_connections=%d reached for user='%s' active=%d",
+		         ip, acc->max_connections, acc->user, (int)acc->active);
+		goto fail;
 	}
 
 	{ uint8_t r[3] = { MSG_CLIENT_LOGIN_ACK, 0, 0 };
@@ -179,16 +170,20 @@ static bool ncd_handle_login(S_CLIENT *cl,
 	  for (i = 0; i < (int)hlen; i++)
 	      cl->session_key[i % 14] ^= (uint8_t)hash[i]; }
 	crypt_key_spread(cl->session_key, spread);
-	memcpy(cl->key1, spread,     8);
-	memcpy(cl->key2, spread + 8, 8);
+	crypt_ede2_setkey(&cl->ks, spread);
 	secure_zero(spread, sizeof(spread));
 
 	cl->caid      = acc->caid;
 	cl->client_id = sid;
 	cl->is_mgcamd = (g_cfg.newcamd_mgclient || acc->ncaids > 0) ? 1 : 0;
 	tcmg_strlcpy(cl->proto, cl->is_mgcamd ? "mgcamd" : "newcamd", sizeof(cl->proto));
-	tcmg_strlcpy(cl->user,        acc->user,            CFGKEY_LEN);
+	client_set_user(cl, acc->user);
 	tcmg_strlcpy(cl->client_name, cfg_client_name(sid), sizeof(cl->client_name));
+	if (cl->account)
+	{
+		client_drop_account(cl);
+		cfg_account_release(cl->account);
+	}
 	cl->account = acc;
 
 	log_set_user(acc->user);
@@ -213,6 +208,10 @@ static bool ncd_handle_login(S_CLIENT *cl,
 		         ip, user, acc->caid, acc->max_connections);
 	}
 	return true;
+
+fail:
+	cfg_account_release(acc);
+	return false;
 }
 
 static void ncd_handle_card(S_CLIENT *cl, uint16_t sid, uint16_t mid, uint32_t pid)
@@ -239,17 +238,116 @@ static void ncd_handle_card(S_CLIENT *cl, uint16_t sid, uint16_t mid, uint32_t p
 	}
 }
 
+typedef struct {
+	S_JOB     job;
+	S_ECM_CTX ctx;
+	uint8_t   cmd, src;
+	uint16_t  sid, mid, caid;
+	uint32_t  pid;
+	int32_t   dlen, res;
+	int64_t   t0_ms;
+	uint8_t   md5[16];
+	uint8_t   cw[CW_LEN];
+	uint8_t   data[NC_MSG_MAX];
+} S_NCD_JOB;
+
+static void ncd_ecm_result(S_CLIENT *cl, uint8_t cmd,
+                             uint16_t sid, uint16_t mid, uint32_t pid,
+                             uint16_t ecm_caid, int32_t dlen, int32_t res,
+                             uint8_t src, const uint8_t *cw, int64_t t0_ms)
+{
+	uint8_t    resp[32];
+	long       ms  = (long)tcmg_elapsed_ms(t0_ms);
+	S_ACCOUNT *acc = cl->account;
+
+	if (src != CW_SRC_EMU)
+		tcmg_log_dbg(D_ECM, "%s ECM %s user='%s' caid=%04X sid=%04X",
+		             cl->ip, src == CW_SRC_L1    ? "L1 cache HIT" :
+		                     src == CW_SRC_CACHE ? "cache HIT" :
+		                     src == CW_SRC_NEGATIVE ? "negative cache HIT" :
+		                     src == CW_SRC_EXPIRED  ? "deadline missed" : "coalesced",
+		             cl->user, ecm_caid, sid);
+
+	resp[0] = cmd;
+	if (res == EMU_OK)
+	{
+		resp[1] = 0;
+		resp[2] = CW_LEN;
+		memcpy(resp + 3, cw, CW_LEN);
+		nc_send(cl, resp, 19, sid, mid, pid);
+		secure_zero(resp, sizeof(resp));
+		if (acc)
+		{
+			atomic_store(&acc->last_seen, time(NULL));
+
+			pthread_mutex_lock(&acc->stat_mtx);
+			acc->cw_found++;
+			acc->ecm_total++;
+			if (src == CW_SRC_L1)
+				acc->cw_l1_hit++;
+			else if (src == CW_SRC_CACHE)
+				acc->cw_l2_hit++;
+			acc->cw_time_total_ms += ms;
+			if (acc->cw_time_min_ms == 0 || ms < acc->cw_time_min_ms)
+				acc->cw_time_min_ms = ms;
+			if (ms > acc->cw_time_max_ms)
+				acc->cw_time_max_ms = ms;
+			pthread_mutex_unlock(&acc->stat_mtx);
+		}
+	}
+	else
+	{
+		resp[1] = resp[2] = 0;
+		nc_send(cl, resp, 3, sid, mid, pid);
+
+		if (acc)
+		{
+			pthread_mutex_lock(&acc->stat_mtx);
+			acc->cw_not++;
+			acc->ecm_total++;
+			if (src == CW_SRC_NEGATIVE)
+				acc->cw_neg++;
+			pthread_mutex_unlock(&acc->stat_mtx);
+		}
+	}
+
+	log_cw_result(ecm_caid, sid, dlen, cw, res == EMU_OK, src, (int32_t)ms, cl->user);
+}
+
+static void ncd_job_run(S_JOB *job)
+{
+	S_NCD_JOB *j = (S_NCD_JOB *)job;
+
+	log_set_user(j->ctx.user);
+	j->res = cw_cache_decode(j->md5, j->caid, j->sid, j->data, j->dlen,
+	                         j->cw, &j->ctx, &j->src);
+}
+
+static void ncd_job_done(S_JOB *job)
+{
+	S_NCD_JOB *j = (S_NCD_JOB *)job;
+
+	if (job->expired)
+	{
+		j->res = EMU_KEY_NOT_FOUND;
+		j->src = CW_SRC_EXPIRED;
+	}
+	engine_ecm_latency(tcmg_elapsed_ms(j->t0_ms));
+	ncd_ecm_result(&job->conn->cl, j->cmd, j->sid, j->mid, j->pid,
+	               j->caid, j->dlen, j->res, j->src, j->cw, j->t0_ms);
+}
+
 static void ncd_handle_ecm(S_CLIENT *cl, uint8_t cmd,
                              const uint8_t *data, int32_t dlen,
                              uint16_t sid, uint16_t mid, uint32_t pid,
                              uint16_t caid_hdr)
 {
-	uint8_t   resp[32], cw[CW_LEN];
-	int32_t   res;
-	uint16_t  ecm_caid;
-	S_ECM_CTX ctx;
-	int64_t   t0_ms = 0;
-	long      ms    = 0;
+	uint8_t    cw[CW_LEN], src, ecm_md5[16];
+	int32_t    res;
+	uint16_t   ecm_caid;
+	S_ECM_CTX  ctx;
+	S_NCD_JOB *j;
+	int64_t    t0_ms;
 
 	memset(cw, 0, CW_LEN);
 
@@ -316,283 +414,288 @@ static void ncd_handle_ecm(S_CLIENT *cl, uint8_t cmd,
 	ctx.caid      = ecm_caid;
 	ctx.thread_id = cl->thread_id;
 	ctx.account   = cl->account;
+	ctx.l1        = conn_l1(cl->conn);
 
-	uint8_t ecm_md5[16];
 	crypt_md5_hash(data, (size_t)dlen, ecm_md5);
-	bool cache_hit = cw_cache_lookup(ecm_md5, cw);
 
 	t0_ms = tcmg_mono_ms();
 
-	if (cache_hit)
+	res = cw_cache_probe(ecm_md5, ecm_caid, sid, cw, &ctx, &src);
+	if (res != CW_PROBE_MISS)
 	{
-		tcmg_log_dbg(D_ECM, "%s ECM cache HIT user='%s' caid=%04X sid=%04X",
-		             cl->ip, cl->user, ecm_caid, sid);
-		res = EMU_OK;
+		ncd_ecm_result(cl, cmd, sid, mid, pid, ecm_caid, dlen, res, src, cw, t0_ms);
+		secure_zero(cw, sizeof(cw));
+		return;
 	}
-	else
+
+	if (!engine_ecm_admit())
 	{
-		res = emu_process(ecm_caid, sid, data, dlen, cw, &ctx);
-		if (res == EMU_OK)
-			cw_cache_store(ecm_md5, cw);
+		tcmg_log_dbg(D_NEWCAMD, "%s ECM mid=%04X shed: server overloaded user='%s'",
+		             cl->ip, mid, cl->user);
+		ncd_ecm_nak(cl, cmd, sid, mid, pid);
+		return;
 	}
 
-	ms = (long)tcmg_elapsed_ms(t0_ms);
-
-	resp[0] = cmd;
-	if (res == EMU_OK)
+	j = (S_NCD_JOB *)tcmg_malloc(sizeof(*j));
+	if (!j)
 	{
-		resp[1] = 0;
-		resp[2] = CW_LEN;
-		memcpy(resp + 3, cw, CW_LEN);
-		nc_send(cl, resp, 19, sid, mid, pid);
-		atomic_store(&cl->account->last_seen, time(NULL));
-
-		pthread_mutex_lock(&cl->account->stat_mtx);
-		cl->account->cw_found++;
-		cl->account->ecm_total++;
-		cl->account->cw_time_total_ms += ms;
-		if (cl->account->cw_time_min_ms == 0 || ms < cl->account->cw_time_min_ms)
-			cl->account->cw_time_min_ms = ms;
-		if (ms > cl->account->cw_time_max_ms)
-			cl->account->cw_time_max_ms = ms;
-		pthread_mutex_unlock(&cl->account->stat_mtx);
+		ncd_ecm_nak(cl, cmd, sid, mid, pid);
+		return;
 	}
-	else
+	j->job.conn = cl->conn;
+	j->job.account = cfg_account_ref(cl->account);
+	j->job.size = sizeof(*j);
+	j->job.run  = ncd_job_run;
+	j->job.done = ncd_job_done;
+	j->job.prio = cl->account->group;
+	j->job.deadline_ms = t0_ms + g_cfg.ecm_budget_ms;
+	j->ctx      = ctx;
+	j->cmd      = cmd;
+	j->sid      = sid;
+	j->mid      = mid;
+	j->pid      = pid;
+	j->caid     = ecm_caid;
+	j->dlen     = dlen;
+	j->t0_ms    = t0_ms;
+	memcpy(j->md5,  ecm_md5, sizeof(j->md5));
+	memcpy(j->data, data,    (size_t)dlen);
+
+	if (!engine_job_submit(&j->job))
 	{
-		resp[1] = resp[2] = 0;
-		nc_send(cl, resp, 3, sid, mid, pid);
-
-		pthread_mutex_lock(&cl->account->stat_mtx);
-		cl->account->cw_not++;
-		cl->account->ecm_total++;
-		pthread_mutex_unlock(&cl->account->stat_mtx);
+		tcmg_log_dbg(D_NEWCAMD, "%s ECM mid=%04X dropped: backlog full (%d) for user='%s'",
+		             cl->ip, mid, ECM_BACKLOG_MAX, cl->user);
+		ncd_ecm_nak(cl, cmd, sid, mid, pid);
+		cfg_account_release(j->job.account);
+		secure_zero(j, sizeof(*j));
+		free(j);
 	}
+}
 
-	log_cw_result(ecm_caid, sid, dlen, cw, res == EMU_OK, cache_hit, (int32_t)ms, cl->user);
-	secure_zero(cw, sizeof(cw));
+static int32_t ncd_on_open(S_CONN *c)
+{
+	conn_expect(c, 2);
+	return nc_init(&c->cl, g_cfg.newcamd_key);
 }
 
-void *handle_newcamd_client(void *arg)
+static int32_t ncd_on_data(S_CONN *c)
 {
-	S_CONN_ARGS *args = (S_CONN_ARGS *)arg;
-	S_CLIENT     cl;
-	uint8_t      data[NC_MSG_MAX];
-	uint16_t     sid, mid, caid_hdr;
-	uint32_t     pid;
-	int32_t      dlen;
-
-	memset(&cl, 0, sizeof(cl));
-	cl.fd           = args->fd;
-	cl.thread_id    = (uint32_t)(uintptr_t)pthread_self();
-	cl.connect_time = time(NULL);
-	cl.last_ecm_time = time(NULL);
-	tcmg_strlcpy(cl.ip, args->ip, MAXIPLEN);
-	free(args);
-
-	log_set_type(LOG_TYPE_CLIENT);
-	client_register(&cl);
-	tcmg_log_dbg(D_CONN, "%s new newcamd/mgcamd connection fd=%d tid=%u",
-	             cl.ip, cl.fd, cl.thread_id);
-
-	nc_init(&cl, g_cfg.newcamd_key, g_cfg.sock_timeout);
-
-	while (g_running && !cl.kill_flag)
-	{
-		if (cl.account && cl.account->max_idle > 0)
-		{
-			time_t idle = time(NULL) - cl.last_ecm_time;
-			if (idle >= cl.account->max_idle)
-			{
-				tcmg_log("%s idle timeout: %lds >= max_idle=%ds disconnecting user='%s'",
-				         cl.ip, (long)idle, cl.account->max_idle, cl.user);
-				break;
-			}
-		}
+	S_CLIENT *cl = &c->cl;
+	uint8_t   data[NC_MSG_MAX];
+	uint16_t  sid, mid, caid_hdr, total_len;
+	uint32_t  pid;
+	int32_t   dlen;
 
-		dlen = nc_recv(&cl, data, &sid, &mid, &pid, &caid_hdr);
-		if (dlen < 0)
+	if (c->want == 2)
+	{
+		total_len = be16(c->rbuf);
+		if (total_len == 0 || total_len > NC_MSG_MAX)
 		{
-			if (cl.user[0])
-				tcmg_log("%s disconnected user='%s' ecm_total=%llu cw_found=%lld cw_not=%lld",
-				         cl.ip, cl.user,
-				         cl.account ? (unsigned long long)cl.account->ecm_total : 0ULL,
-				         cl.account ? (long long)cl.account->cw_found : 0LL,
-				         cl.account ? (long long)cl.account->cw_not : 0LL);
-			else
-				tcmg_log_dbg(D_CONN, "%s disconnected (before login)", cl.ip);
-			break;
+			tcmg_log_dbg(D_NEWCAMD, "%s bad frame length=%u -- disconnecting", cl->ip, total_len);
+			return -1;
 		}
+		c->want = 2 + (uint32_t)total_len;
+		return 0;
+	}
 
-		uint8_t cmd = data[0];
-		tcmg_log_dbg(D_NEWCAMD, "%s recv cmd=0x%02X dlen=%d sid=%04X mid=%04X",
-		             cl.ip, cmd, dlen, sid, mid);
+	total_len = (uint16_t)(c->rlen - 2);
+	dlen = nc_decode(cl, c->rbuf + 2, total_len, data, &sid, &mid, &pid, &caid_hdr);
+	conn_expect(c, 2);
+	if (dlen < 0)
+	{
+		tcmg_log_dbg(D_NEWCAMD, "%s malformed frame length=%u -- disconnecting", cl->ip, total_len);
+		return -1;
+	}
 
-		if      (cmd == MSG_CLIENT_LOGIN)
-		{ if (!ncd_handle_login(&cl, data, dlen, sid, mid, pid)) break; }
-		else if (cmd == MSG_CARD_DATA_REQ)
-		{ ncd_handle_card(&cl, sid, mid, pid); }
-		else if (cmd == MSG_KEEPALIVE)
-		{
-			tcmg_log_dbg(D_NEWCAMD, "%s KEEPALIVE user='%s'", cl.ip, cl.user);
-			if (g_cfg.newcamd_keepalive)
-				nc_send(&cl, data, dlen, sid, mid, pid);
-		}
-		else if (cmd == MSG_ECM_0 || cmd == MSG_ECM_1)
-		{ ncd_handle_ecm(&cl, cmd, data, dlen, sid, mid, pid, caid_hdr); }
-		else if (cmd == MSG_GET_VERSION)
-		{
-			tcmg_log_dbg(D_NEWCAMD, "%s GET_VERSION request", cl.ip);
-			nc_send_version(&cl, mid);
-		}
-		else
+	uint8_t cmd = data[0];
+	tcmg_log_dbg(D_NEWCAMD, "%s recv cmd=0x%02X dlen=%d sid=%04X mid=%04X",
+	             cl->ip, cmd, dlen, sid, mid);
+
+	if      (cmd == MSG_CLIENT_LOGIN)
+	{ if (!ncd_handle_login(cl, data, dlen, sid, mid, pid)) return -1; }
+	else if (cmd == MSG_CARD_DATA_REQ)
+	{ ncd_handle_card(cl, sid, mid, pid); }
+	else if (cmd == MSG_KEEPALIVE)
+	{
+		tcmg_log_dbg(D_NEWCAMD, "%s KEEPALIVE user='%s'", cl->ip, cl->user);
+		if (g_cfg.newcamd_keepalive)
+			nc_send(cl, data, dlen, sid, mid, pid);
+	}
+	else if (cmd == MSG_ECM_0 || cmd == MSG_ECM_1)
+	{ ncd_handle_ecm(cl, cmd, data, dlen, sid, mid, pid, caid_hdr); }
+	else if (cmd == MSG_GET_VERSION)
+	{
+		tcmg_log_dbg(D_NEWCAMD, "%s GET_VERSION request", cl->ip);
+		nc_send_version(cl, mid);
+	}
+	else
+	{
+		tcmg_log_dbg(D_NEWCAMD, "%s unknown cmd=0x%02X dlen=%d -- ignored",
+		             cl->ip, cmd, dlen);
+	}
+	return 0;
+}
+
+static int32_t ncd_on_tick(S_CONN *c)
+{
+	S_CLIENT *cl = &c->cl;
+
+	if (cl->account && cl->account->max_idle > 0)
+	{
+		time_t idle = time(NULL) - cl->last_ecm_time;
+		if (idle >= cl->account->max_idle)
 		{
-			tcmg_log_dbg(D_NEWCAMD, "%s unknown cmd=0x%02X dlen=%d -- ignored",
-			             cl.ip, cmd, dlen);
+			tcmg_log("%s idle timeout: %lds >= max_idle=%ds disconnecting user='%s'",
+			         cl->ip, (long)idle, cl->account->max_idle, cl->user);
+			return -1;
 		}
 	}
+	return 0;
+}
 
-	client_unregister(&cl);
-	if (cl.account)
-		atomic_fetch_sub(&cl.account->active, 1);
-
-	tcmg_log_dbg(D_CONN, "%s connection closed fd=%d tid=%u", cl.ip, cl.fd, cl.thread_id);
-	close(cl.fd);
-	atomic_fetch_sub(&g_active_conns, 1);
-	return NULL;
+static void ncd_on_close(S_CONN *c, bool peer)
+{
+	S_CLIENT *cl = &c->cl;
+
+	if (!peer) return;
+	if (cl->user[0])
+		tcmg_log("%s disconnected user='%s' ecm_total=%llu cw_found=%lld cw_not=%lld",
+		         cl->ip, cl->user,
+		         cl->account ? (unsigned long long)cl->account->ecm_total : 0ULL,
+		         cl->account ? (long long)cl->account->cw_found : 0LL,
+		         cl->account ? (long long)cl->account->cw_not : 0LL);
+	else
+		tcmg_log_dbg(D_CONN, "%s disconnected (before login)", cl->ip);
 }
 
-static void *ncd_accept_thread(void *arg)
+static const S_CONN_OPS s_ncd_ops = {
+	"newcamd", sizeof(S_CONN),
+	ncd_on_open, ncd_on_data, ncd_on_tick, ncd_on_close, 0
+};
+
+static bool ncd_accept_one(int srv_fd)
 {
-	(void)arg;
-	pthread_attr_t attr;
-	pthread_attr_init(&attr);
-	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-	pthread_attr_setstacksize(&attr, 256 * 1024);
+	struct sockaddr_in ca;
+	socklen_t clen = sizeof(ca);
+	int cfd = (int)accept(srv_fd, (struct sockaddr *)&ca, &clen);
+	if (cfd < 0)
+	{
+		if (s_ncd_running && errno != EAGAIN && errno != EWOULDBLOCK)
+			tcmg_log_dbg(D_CONN, "accept() failed errno=%d (%s)",
+			             errno, strerror(errno));
+		return false;
+	}
 
-	while (s_ncd_running)
+	int active = atomic_fetch_add(&g_active_conns, 1);
+	if (active >= g_cfg.max_clients)
 	{
-		fd_set rfds;
-		FD_ZERO(&rfds);
-		FD_SET(s_ncd_srv_fd, &rfds);
-		struct timeval tv = { 1, 0 };
-		if (select(s_ncd_srv_fd + 1, &rfds, NULL, NULL, &tv) <= 0)
-			continue;
+		atomic_fetch_sub(&g_active_conns, 1);
+		close(cfd);
+		tcmg_log("MAX_CLIENTS=%d reached -- connection rejected active=%d",
+		         g_cfg.max_clients, active);
+		return true;
+	}
 
-		struct sockaddr_in ca;
-		socklen_t clen = sizeof(ca);
-		int cfd = (int)accept(s_ncd_srv_fd, (struct sockaddr *)&ca, &clen);
-		if (cfd < 0)
-		{
-			if (s_ncd_running)
-				tcmg_log_dbg(D_CONN, "accept() failed errno=%d (%s)",
-				             errno, strerror(errno));
-			continue;
-		}
+	char ip[MAXIPLEN];
+	inet_ntop(AF_INET, &ca.sin_addr, ip, MAXIPLEN);
+	ip[MAXIPLEN - 1] = '\0';
 
-		int active = atomic_fetch_add(&g_active_conns, 1);
-		if (active >= MAX_CONNS)
-		{
-			atomic_fetch_sub(&g_active_conns, 1);
-			close(cfd);
-			tcmg_log("MAX_CONNS=%d reached -- connection rejected active=%d",
-			         MAX_CONNS, active);
-			continue;
-		}
+	tcmg_log_dbg(D_CONN, "%s accepted newcamd connection fd=%d active=%d",
+	             ip, cfd, active + 1);
 
-		S_CONN_ARGS *args = (S_CONN_ARGS *)malloc(sizeof(S_CONN_ARGS));
-		if (!args)
-		{
-			atomic_fetch_sub(&g_active_conns, 1);
-			close(cfd);
-			tcmg_log("out of memory -- connection rejected active=%d", active);
-			continue;
-		}
-		args->fd = cfd;
-		inet_ntop(AF_INET, &ca.sin_addr, args->ip, MAXIPLEN);
-		args->ip[MAXIPLEN - 1] = '\0';
+	if (!engine_attach(cfd, ip, &s_ncd_ops))
+	{
+		tcmg_log("%s connection rejected -- cannot attach active=%d", ip, active);
+		atomic_fetch_sub(&g_active_conns, 1);
+		close(cfd);
+	}
+	return true;
+}
 
-		tcmg_log_dbg(D_CONN, "%s accepted newcamd connection fd=%d active=%d",
-		             args->ip, cfd, active + 1);
+static void *ncd_accept_thread(void *arg)
+{
+	int32_t slot   = (int32_t)(intptr_t)arg;
+	int     srv_fd = s_ncd_srv_fd[slot];
 
-		pthread_t tid;
-		int rc = pthread_create(&tid, &attr, handle_newcamd_client, args);
-		if (rc != 0)
-		{
-			tcmg_log("pthread_create failed: rc=%d errno=%d (%s)",
-			         rc, errno, strerror(errno));
-			atomic_fetch_sub(&g_active_conns, 1);
-			close(cfd);
-			free(args);
-		}
+	if (s_ncd_nacc > 1)
+		tcmg_pin_thread(slot);
+
+	while (s_ncd_running)
+	{
+		if (tcmg_poll_in(srv_fd, 1000) <= 0)
+			continue;
+
+		for (int32_t i = 0; i < ACCEPT_BURST && s_ncd_running; i++)
+			if (!ncd_accept_one(srv_fd)) break;
 	}
 
-	pthread_attr_destroy(&attr);
-	tcmg_log_dbg(D_CONN, "%s", "accept thread exiting");
+	tcmg_log_dbg(D_CONN, "accept thread %d exiting", slot);
 	return NULL;
 }
 
+static void ncd_close_listeners(void)
+{
+	for (int32_t i = 0; i < s_ncd_nacc; i++)
+	{
+		if (s_ncd_srv_fd[i] >= 0) close(s_ncd_srv_fd[i]);
+		s_ncd_srv_fd[i] = -1;
+	}
+	s_ncd_nacc = 0;
+}
+
 int32_t newcamd_start(void)
 {
+	int32_t n;
+
 	if (!g_cfg.newcamd_port) {
 		tcmg_log_dbg(D_NEWCAMD, "%s", "disabled (port=0)");
 		return -1;
 	}
 
-	s_ncd_srv_fd = (int)socket(AF_INET, SOCK_STREAM, 0);
-	if (s_ncd_srv_fd < 0)
-	{
-		tcmg_log("socket() failed errno=%d (%s)", errno, strerror(errno));
-		return -1;
-	}
-
-	{ int opt = 1;
-	  setsockopt(s_ncd_srv_fd, SOL_SOCKET, SO_REUSEADDR, SO_CAST(&opt), sizeof(opt)); }
-
-	struct sockaddr_in sa;
-	memset(&sa, 0, sizeof(sa));
-	sa.sin_family = AF_INET;
 	if (g_cfg.newcamd_bindaddr[0])
-	{
-		inet_pton(AF_INET, g_cfg.newcamd_bindaddr, &sa.sin_addr);
 		tcmg_log_dbg(D_NEWCAMD, "binding to %s:%d", g_cfg.newcamd_bindaddr, g_cfg.newcamd_port);
-	}
 	else
-	{
-		sa.sin_addr.s_addr = INADDR_ANY;
 		tcmg_log_dbg(D_NEWCAMD, "binding to *:%d", g_cfg.newcamd_port);
-	}
-	sa.sin_port = htons((uint16_t)g_cfg.newcamd_port);
 
-	if (bind(s_ncd_srv_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+	s_ncd_nacc = net_acceptors();
+	for (n = 0; n < s_ncd_nacc; n++)
 	{
-		tcmg_log("bind() failed port=%d errno=%d (%s)",
-		         g_cfg.newcamd_port, errno, strerror(errno));
-		close(s_ncd_srv_fd);
-		s_ncd_srv_fd = -1;
-		return -1;
-	}
-	if (listen(s_ncd_srv_fd, 128) < 0)
-	{
-		tcmg_log("listen() failed errno=%d (%s)", errno, strerror(errno));
-		close(s_ncd_srv_fd);
-		s_ncd_srv_fd = -1;
-		return -1;
+		s_ncd_srv_fd[n] = net_listen(g_cfg.newcamd_bindaddr, g_cfg.newcamd_port, 128, s_ncd_nacc > 1);
+		if (s_ncd_srv_fd[n] < 0)
+		{
+			tcmg_log("listen failed port=%d errno=%d (%s)",
+			         g_cfg.newcamd_port, errno, strerror(errno));
+			s_ncd_nacc = n;
+			ncd_close_listeners();
+			return -1;
+		}
 	}
 
 	s_ncd_running = 1;
-	int rc = pthread_create(&s_ncd_thread, NULL, ncd_accept_thread, NULL);
-	if (rc != 0)
+	for (n = 0; n < s_ncd_nacc; n++)
+	{
+		int rc = pthread_create(&s_ncd_thread[n], NULL, ncd_accept_thread, (void *)(intptr_t)n);
+		if (rc != 0)
+		{
+			tcmg_log("pthread_create failed rc=%d errno=%d (%s)",
+			         rc, errno, strerror(errno));
+			break;
+		}
+	}
+	if (n == 0)
 	{
-		tcmg_log("pthread_create failed rc=%d errno=%d (%s)",
-		         rc, errno, strerror(errno));
 		s_ncd_running = 0;
-		close(s_ncd_srv_fd);
-		s_ncd_srv_fd = -1;
+		ncd_close_listeners();
 		return -1;
 	}
+	for (int32_t i = n; i < s_ncd_nacc; i++)
+	{
+		close(s_ncd_srv_fd[i]);
+		s_ncd_srv_fd[i] = -1;
+	}
+	s_ncd_nacc = n;
 
-	tcmg_log("listening on port=%d mgclient=%d keepalive=%d sock_timeout=%ds",
-	         g_cfg.newcamd_port, g_cfg.newcamd_mgclient,
+	tcmg_log("listening on port=%d acceptors=%d mgclient=%d keepalive=%d sock_timeout=%ds",
+	         g_cfg.newcamd_port, s_ncd_nacc, g_cfg.newcamd_mgclient,
 	         g_cfg.newcamd_keepalive, g_cfg.sock_timeout);
 	return 0;
 }
@@ -601,11 +704,8 @@ void newcamd_stop(void)
 {
 	tcmg_log_dbg(D_NEWCAMD, "%s", "stopping...");
 	s_ncd_running = 0;
-	if (s_ncd_srv_fd >= 0)
-	{
-		close(s_ncd_srv_fd);
-		s_ncd_srv_fd = -1;
-	}
-	pthread_join(s_ncd_thread, NULL);
+	for (int32_t i = 0; i < s_ncd_nacc; i++)
+		pthread_join(s_ncd_thread[i], NULL);
+	ncd_close_listeners();
 	tcmg_log_dbg(D_NEWCAMD, "%s", "stopped");
 }
@@ -6,6 +6,5 @@
 
 int32_t newcamd_start(void);
 void    newcamd_stop(void);
-void   *handle_newcamd_client(void *arg);
 
 #endif
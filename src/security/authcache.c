@@ -0,0 +1,83 @@
+#define MODULE_LOG_PREFIX "auth"
+#include "../../globals.h"
+
+typedef struct {
+    uint8_t tag[16];
+    time_t  ts;
+    int8_t  valid;
+} S_AUTH_CACHE_ENTRY;
+
+static S_AUTH_CACHE_ENTRY s_auth_cache[AUTH_CACHE_SIZE];
+static pthread_mutex_t    s_auth_mtx    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t     s_auth_once   = PTHREAD_ONCE_INIT;
+static uint8_t            s_auth_secret[16];
+static bool               s_auth_keyed  = false;
+
+static void auth_init_secret(void)
+{
+    s_auth_keyed = csprng(s_auth_secret, sizeof(s_auth_secret));
+}
+
+static bool auth_tag(const char *user, const char *pass, const char *hash, uint8_t *tag)
+{
+    uint8_t buf[16 + CFGKEY_LEN * 2 + AUTH_HASH_MAX + 3];
+    size_t  ul = strlen(user), pl = strlen(pass), hl = strlen(hash), n = 0;
+
+    pthread_once(&s_auth_once, auth_init_secret);
+    if (!s_auth_keyed || ul >= CFGKEY_LEN || pl >= CFGKEY_LEN || hl >= AUTH_HASH_MAX)
+        return false;
+
+    memcpy(buf + n, s_auth_secret, 16); n += 16;
+    memcpy(buf + n, user, ul + 1);      n += ul + 1;
+    memcpy(buf + n, pass, pl + 1);      n += pl + 1;
+    memcpy(buf + n, hash, hl + 1);      n += hl + 1;
+    crypt_md5_hash(buf, n, tag);
+    secure_zero(buf, n);
+    return true;
+}
+
+static inline uint32_t auth_idx(const uint8_t *tag)
+{
+    return (((uint32_t)tag[0] << 8) | tag[1]) & (AUTH_CACHE_SIZE - 1);
+}
+
+bool auth_cache_check(const char *user, const char *pass, const char *hash)
+{
+    uint8_t tag[16];
+    bool    hit = false;
+    if (!auth_tag(user, pass, hash, tag)) return false;
+
+    pthread_mutex_lock(&s_auth_mtx);
+    S_AUTH_CACHE_ENTRY *e = &s_auth_cache[auth_idx(tag)];
+    if (e->valid && ct_memeq(e->tag, tag, 16) &&
+        (time(NULL) - e->ts) < AUTH_CACHE_TTL_S)
+        hit = true;
+    pthread_mutex_unlock(&s_auth_mtx);
+
+    secure_zero(tag, sizeof(tag));
+    tcmg_log_dbg(D_NEWCAMD, "auth cache %s user='%s'", hit ? "hit" : "miss", user);
+    return hit;
+}
+
+void auth_cache_store(const char *user, const char *pass, const char *hash)
+{
+    uint8_t tag[16];
+    if (!auth_tag(user, pass, hash, tag)) return;
+
+    pthread_mutex_lock(&s_auth_mtx);
+    S_AUTH_CACHE_ENTRY *e = &s_auth_cache[auth_idx(tag)];
+    memcpy(e->tag, tag, 16);
+    e->ts    = time(NULL);
+    e->valid = 1;
+    pthread_mutex_unlock(&s_auth_mtx);
+
+    secure_zero(tag, sizeof(tag));
+}
+
+void auth_cache_flush(void)
+{
+    pthread_mutex_lock(&s_auth_mtx);
+    secure_zero(s_auth_cache, sizeof(s_auth_cache));
+    pthread_mutex_unlock(&s_auth_mtx);
+    tcmg_log_dbg(D_NEWCAMD, "%s", "auth cache flushed");
+}
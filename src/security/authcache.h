@@ -0,0 +1,8 @@
+#ifndef TCMG_AUTHCACHE_H_
+#define TCMG_AUTHCACHE_H_
+
+bool auth_cache_check(const char *user, const char *pass, const char *hash);
+void auth_cache_store(const char *user, const char *pass, const char *hash);
+void auth_cache_flush(void);
+
+#endif
@@ -0,0 +1,187 @@
+#define MODULE_LOG_PREFIX "bench"
+#include "../globals.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define BENCH_HAVE_TSC 1
+#endif
+
+_Atomic uint16_t g_dblevel = 0;
+S_CONFIG         g_cfg;
+
+void tcmg_log_txt(const char *mod, const char *fmt, ...)
+{
+	va_list ap;
+	fprintf(stderr, "(%s) ", mod ? mod : "-");
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+}
+
+void tcmg_log_hex(const char *mod, const uint8_t *buf, int32_t n, const char *fmt, ...)
+{
+}
+
+typedef struct {
+	const char *name;
+	size_t      bytes;
+	void      (*fn)(size_t bytes);
+} S_BENCH;
+
+static uint8_t    s_key[16], s_iv[8], s_buf[4096], s_out[4096];
+static S_EDE2_KS  s_ks;
+static S_CC_CRYPT s_cc;
+static volatile uint8_t s_sink;
+static int32_t    s_min_ms = 200;
+
+static void b_ede2_cbc_enc(size_t n)    { crypt_ede2_cbc(s_key, s_iv, s_buf, s_out, n, true); }
+static void b_ede2_cbc_dec(size_t n)    { crypt_ede2_cbc(s_key, s_iv, s_buf, s_out, n, false); }
+static void b_ede2_cbc_ks_dec(size_t n) { crypt_ede2_cbc_ks(&s_ks, s_iv, s_buf, s_out, n, false); }
+static void b_ede2_ecb_enc(size_t n)    { crypt_ede2_ecb(s_key, s_buf, s_out, n, true); }
+static void b_ede2_ecb_dec(size_t n)    { crypt_ede2_ecb(s_key, s_buf, s_out, n, false); }
+static void b_md5_hash(size_t n)        { crypt_md5_hash(s_buf, n, s_out); }
+static void b_sha1_hash(size_t n)       { sha1_hash(s_buf, n, s_out); }
+static void b_cc_encrypt(size_t n)      { crypt_cc_encrypt(&s_cc, s_out, (int)n); }
+static void b_cc_decrypt(size_t n)      { crypt_cc_decrypt(&s_cc, s_out, (int)n); }
+static void b_csprng(size_t n)          { csprng(s_out, n); }
+
+static void b_md5_crypt(size_t n)
+{
+	char out[64];
+	crypt_md5_crypt("tvcas1234", "$1$tcmgbnch$", out, sizeof(out));
+	s_sink ^= (uint8_t)out[n & 31];
+}
+
+static const S_BENCH s_benches[] = {
+	{ "ede2_cbc_enc",    64,  b_ede2_cbc_enc    },
+	{ "ede2_cbc_enc",    184, b_ede2_cbc_enc    },
+	{ "ede2_cbc_dec",    64,  b_ede2_cbc_dec    },
+	{ "ede2_cbc_dec",    184, b_ede2_cbc_dec    },
+	{ "ede2_cbc_ks_dec", 184, b_ede2_cbc_ks_dec },
+	{ "ede2_ecb_enc",    64,  b_ede2_ecb_enc    },
+	{ "ede2_ecb_dec",    64,  b_ede2_ecb_dec    },
+	{ "ede2_ecb_dec",    184, b_ede2_ecb_dec    },
+	{ "md5_hash",        64,  b_md5_hash        },
+	{ "md5_hash",        184, b_md5_hash        },
+	{ "md5_crypt",       9,   b_md5_crypt       },
+	{ "sha1_hash",       16,  b_sha1_hash       },
+	{ "sha1_hash",       184, b_sha1_hash       },
+	{ "cc_encrypt",      20,  b_cc_encrypt      },
+	{ "cc_encrypt",      184, b_cc_encrypt      },
+	{ "cc_decrypt",      20,  b_cc_decrypt      },
+	{ "cc_decrypt",      184, b_cc_decrypt      },
+	{ "csprng",          8,   b_csprng          },
+	{ "csprng",          14,  b_csprng          },
+	{ "csprng",          16,  b_csprng          },
+};
+
+static uint64_t bench_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t bench_cycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static void bench_run(const S_BENCH *b, bool last)
+{
+	uint64_t iters = 0, batch = 16, t0, t1, c0, c1, ns;
+	uint64_t deadline = (uint64_t)s_min_ms * 1000000ULL;
+	uint64_t i;
+
+	for (i = 0; i < batch; i++) b->fn(b->bytes);
+
+	t0 = bench_ns();
+	c0 = bench_cycles();
+	do
+	{
+		for (i = 0; i < batch; i++) b->fn(b->bytes);
+		iters += batch;
+		if (batch < 65536) batch *= 2;
+		t1 = bench_ns();
+	} while (t1 - t0 < deadline);
+	c1 = bench_cycles();
+	ns = t1 - t0;
+
+	double ops_sec   = (double)iters * 1e9 / (double)ns;
+	double ns_op     = (double)ns / (double)iters;
+	double cyc_op    = (double)(c1 - c0) / (double)iters;
+	printf("    { \"name\": \"%s\", \"bytes\": %zu, \"iters\": %llu, "
+	       "\"ns_per_op\": %.1f, \"ops_per_sec\": %.0f, \"mb_per_sec\": %.2f, "
+	       "\"cycles_per_op\": %.1f, \"cycles_per_byte\": %.2f }%s\n",
+	       b->name, b->bytes, (unsigned long long)iters,
+	       ns_op, ops_sec, ops_sec * (double)b->bytes / 1e6,
+	       cyc_op, cyc_op / (double)b->bytes, last ? "" : ",");
+	fflush(stdout);
+}
+
+static void print_usage(const char *prog)
+{
+	fprintf(stderr,
+	        "\nUsage: %s [options]\n\n"
+	        "Options:\n"
+	        "  -k <name>   Crypto kernel: auto, generic, generic-avx2build\n"
+	        "  -t <ms>     Minimum run time per benchmark (default: %d)\n"
+	        "  -f <name>   Only run benchmarks whose name contains <name>\n"
+	        "  -h          Show this help\n\n",
+	        prog, s_min_ms);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filter = NULL;
+	size_t i, n = sizeof(s_benches) / sizeof(s_benches[0]), last = n;
+
+	for (int a = 1; a < argc; a++)
+	{
+		if (strcmp(argv[a], "-k") == 0 && a + 1 < argc)
+			crypt_force_kernel(argv[++a]);
+		else if (strcmp(argv[a], "-t") == 0 && a + 1 < argc)
+		{
+			long v = strtol(argv[++a], NULL, 0);
+			if (v > 0 && v <= 60000) s_min_ms = (int32_t)v;
+		}
+		else if (strcmp(argv[a], "-f") == 0 && a + 1 < argc)
+			filter = argv[++a];
+		else
+		{
+			print_usage(argv[0]);
+			return strcmp(argv[a], "-h") == 0 ? 0 : 1;
+		}
+	}
+
+	crypt_init();
+	for (i = 0; i < sizeof(s_key); i++) s_key[i] = (uint8_t)(i * 17 + 1);
+	for (i = 0; i < sizeof(s_iv);  i++) s_iv[i]  = (uint8_t)(i * 29 + 3);
+	for (i = 0; i < sizeof(s_buf); i++) s_buf[i] = (uint8_t)(i * 131 + 7);
+	crypt_ede2_setkey(&s_ks, s_key);
+	crypt_cc_init(&s_cc, s_key, 16);
+
+	for (i = 0; i < n; i++)
+		if (!filter || strstr(s_benches[i].name, filter)) last = i;
+
+	printf("{\n");
+	printf("  \"version\": \"%s\",\n", TCMG_VERSION);
+	printf("  \"kernel\": \"%s\",\n", crypt_kernel_name());
+#ifdef BENCH_HAVE_TSC
+	printf("  \"cycle_source\": \"tsc\",\n");
+#else
+	printf("  \"cycle_source\": \"none\",\n");
+#endif
+	printf("  \"min_ms\": %d,\n", s_min_ms);
+	printf("  \"results\": [\n");
+	for (i = 0; i < n; i++)
+		if (!filter || strstr(s_benches[i].name, filter))
+			bench_run(&s_benches[i], i == last);
+	printf("  ]\n}\n");
+	return 0;
+}
@@ -0,0 +1,370 @@
+#define MODULE_LOG_PREFIX "check"
+#include "../globals.h"
+
+_Atomic uint16_t g_dblevel = 0;
+S_CONFIG         g_cfg;
+
+static bool    s_verbose = false;
+static int32_t s_fails   = 0;
+static int32_t s_checks  = 0;
+static uint64_t s_rng;
+
+void tcmg_log_txt(const char *mod, const char *fmt, ...)
+{
+	va_list ap;
+	if (!s_verbose) return;
+	fprintf(stderr, "(%s) ", mod ? mod : "-");
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+}
+
+void tcmg_log_hex(const char *mod, const uint8_t *buf, int32_t n, const char *fmt, ...)
+{
+}
+
+#define CHK_ITERS   2000
+#define CHK_MAXLEN  256
+
+static void hexdump(const char *tag, const uint8_t *p, size_t n)
+{
+	size_t i;
+	fprintf(stderr, "    %-4s ", tag);
+	for (i = 0; i < n; i++) fprintf(stderr, "%02x", p[i]);
+	fputc('\n', stderr);
+}
+
+static void check_mem(const char *what, const uint8_t *got, const uint8_t *want, size_t n)
+{
+	s_checks++;
+	if (memcmp(got, want, n) == 0) return;
+	s_fails++;
+	fprintf(stderr, "FAIL %s\n", what);
+	hexdump("got",  got,  n);
+	hexdump("want", want, n);
+}
+
+static size_t unhex(const char *s, uint8_t *out)
+{
+	size_t n = 0;
+	while (s[0] && s[1])
+	{
+		unsigned v;
+		sscanf(s, "%2x", &v);
+		out[n++] = (uint8_t)v;
+		s += 2;
+	}
+	return n;
+}
+
+static uint32_t rnd32(void)
+{
+	s_rng ^= s_rng << 13;
+	s_rng ^= s_rng >> 7;
+	s_rng ^= s_rng << 17;
+	return (uint32_t)(s_rng >> 16);
+}
+
+static void rnd_fill(uint8_t *p, size_t n)
+{
+	while (n--) *p++ = (uint8_t)rnd32();
+}
+
+static void kat_des(void)
+{
+	static const struct { const char *key, *pt, *ct; } v[] = {
+		{ "133457799bbcdff1", "0123456789abcdef", "85e813540f0ab405" },
+		{ "0e329232ea6d0d73", "8787878787878787", "0000000000000000" },
+		{ "0101010101010101", "8000000000000000", "95f8a5e5dd31d900" },
+		{ "0101010101010101", "0000000000000001", "166b40b44aba4bd6" },
+		{ "8001010101010101", "0000000000000000", "95a8d72813daa94d" },
+	};
+	uint8_t key[8], pt[8], ct[8], out[8];
+	size_t i;
+	for (i = 0; i < sizeof(v) / sizeof(v[0]); i++)
+	{
+		unhex(v[i].key, key); unhex(v[i].pt, pt); unhex(v[i].ct, ct);
+		crypt_des_enc(key, pt, out);     check_mem("kat des enc",     out, ct, 8);
+		crypt_des_dec(key, ct, out);     check_mem("kat des dec",     out, pt, 8);
+		crypt_des_ref_enc(key, pt, out); check_mem("kat des ref enc", out, ct, 8);
+		crypt_des_ref_dec(key, ct, out); check_mem("kat des ref dec", out, pt, 8);
+	}
+}
+
+static void kat_ede2(void)
+{
+	static const char KEY[] = "9f3c17a2b5d0481e6a7b92f4c8e05d13";
+	static const char IV[]  = "0102030405060708";
+	static const char PT[]  = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+	static const char CBC[] = "480331c8b8fe06c82db9ad04724c42b5ab41f0ee779148e90f30c9660d6f8fc6";
+	static const char ECB[] = "9472d7e0d29c148b18df956568796cfda39a9e549d5acb092d78acbc416dca49";
+	uint8_t key[16], iv[8], pt[32], cbc[32], ecb[32], out[32];
+	S_EDE2_KS ks;
+
+	unhex(KEY, key); unhex(IV, iv); unhex(PT, pt); unhex(CBC, cbc); unhex(ECB, ecb);
+	crypt_ede2_setkey(&ks, key);
+
+	crypt_ede2_cbc(key, iv, pt, out, 32, true);   check_mem("kat ede2 cbc enc", out, cbc, 32);
+	crypt_ede2_cbc(key, iv, cbc, out, 32, false); check_mem("kat ede2 cbc dec", out, pt, 32);
+	crypt_ede2_ecb(key, pt, out, 32, true);       check_mem("kat ede2 ecb enc", out, ecb, 32);
+	crypt_ede2_ecb(key, ecb, out, 32, false);     check_mem("kat ede2 ecb dec", out, pt, 32);
+	crypt_ede2_cbc_ks(&ks, iv, cbc, out, 32, false); check_mem("kat ede2 cbc_ks dec", out, pt, 32);
+	crypt_ede2_ecb_ks(&ks, ecb, out, 32, false);     check_mem("kat ede2 ecb_ks dec", out, pt, 32);
+}
+
+static void kat_hash(void)
+{
+	static const struct { const char *msg, *md5, *sha1; } v[] = {
+		{ "", "d41d8cd98f00b204e9800998ecf8427e",
+		      "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+		{ "abc", "900150983cd24fb0d6963f7d28e17f72",
+		         "a9993e364706816aba3e25717850c26c9cd0d89d" },
+		{ "message digest", "f96b697d7cb7938d525a2f31aaf161d0",
+		                    "c12252ceda8be8994d5fa0290a47231c1d16aae3" },
+		{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+		  "8215ef0796a20bcaaae116d3876c664a",
+		  "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+		{ "12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+		  "57edf4a22be3c955ac49da2e2107b67a",
+		  "50abf5706a150990a08b2c5ea40fa0e585554732" },
+	};
+	uint8_t want[20], out[20];
+	size_t i;
+	for (i = 0; i < sizeof(v) / sizeof(v[0]); i++)
+	{
+		size_t n = strlen(v[i].msg);
+		unhex(v[i].md5, want);
+		crypt_md5_hash((const uint8_t *)v[i].msg, n, out);
+		check_mem("kat md5", out, want, 16);
+		unhex(v[i].sha1, want);
+		sha1_hash((const uint8_t *)v[i].msg, n, out);
+		check_mem("kat sha1", out, want, 20);
+	}
+}
+
+static void kat_md5_crypt(void)
+{
+	static const struct { const char *pw, *salt, *hash; } v[] = {
+		{ "password", "$1$saltstri$", "$1$saltstri$qQY4WxjABChYG1ccLpfkz/" },
+		{ "1234",     "$1$tcmg$",     "$1$tcmg$nYp6qkj00IgdDEvw6CG3g1"     },
+	};
+	char out[64];
+	size_t i;
+	for (i = 0; i < sizeof(v) / sizeof(v[0]); i++)
+	{
+		s_checks++;
+		if (!crypt_md5_crypt(v[i].pw, v[i].salt, out, sizeof(out)) ||
+		    strcmp(out, v[i].hash) != 0)
+		{
+			s_fails++;
+			fprintf(stderr, "FAIL kat md5_crypt pw=%s\n    got  %s\n    want %s\n",
+			        v[i].pw, out, v[i].hash);
+		}
+	}
+}
+
+static void kat_chacha20(void)
+{
+	static const char KEY[]   = "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f";
+	static const char NONCE[] = "000000090000004a00000000";
+	static const char BLOCK[] = "10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+	                            "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e";
+	uint8_t key[32], nonce[12], want[64], out[64];
+
+	unhex(KEY, key); unhex(NONCE, nonce); unhex(BLOCK, want);
+	crypt_chacha20_block(key, 1, nonce, out);
+	check_mem("kat chacha20 block", out, want, 64);
+}
+
+static void spread_ref(const uint8_t *k14, uint8_t *s16)
+{
+	int i, j, bit;
+	for (i = 0; i < 16; i++)
+	{
+		uint8_t b = 0, p = 1;
+		for (j = 0; j < 7; j++)
+		{
+			bit = i * 7 + j;
+			b = (uint8_t)((b << 1) | ((k14[bit >> 3] >> (7 - (bit & 7))) & 1));
+		}
+		b <<= 1;
+		for (j = 1; j < 8; j++) p ^= (b >> j) & 1;
+		s16[i] = b | p;
+	}
+}
+
+static void kat_spread(void)
+{
+	uint8_t k14[14], want[16], out[16];
+	unhex("0102030405060708091011121314", k14);
+	unhex("018080614029190e0804450210914c29", want);
+	crypt_key_spread(k14, out);
+	check_mem("kat key_spread", out, want, 16);
+}
+
+static void ede2_ref(const uint8_t *key, const uint8_t *iv, const uint8_t *in,
+                     uint8_t *out, size_t len, bool cbc, bool encrypt)
+{
+	uint8_t v[8], blk[8], t[8];
+	size_t i;
+	int j;
+	memcpy(v, iv, 8);
+	for (i = 0; i + 8 <= len; i += 8)
+	{
+		memcpy(blk, in + i, 8);
+		if (encrypt)
+		{
+			if (cbc) for (j = 0; j < 8; j++) blk[j] ^= v[j];
+			crypt_des_ref_enc(key,     blk, t);
+			crypt_des_ref_dec(key + 8, t,   t);
+			crypt_des_ref_enc(key,     t,   out + i);
+			memcpy(v, out + i, 8);
+		}
+		else
+		{
+			crypt_des_ref_dec(key,     blk, t);
+			crypt_des_ref_enc(key + 8, t,   t);
+			crypt_des_ref_dec(key,     t,   out + i);
+			if (cbc) for (j = 0; j < 8; j++) out[i + j] ^= v[j];
+			memcpy(v, blk, 8);
+		}
+	}
+}
+
+static void diff_kernel(uint8_t (*md5_ref)[16], uint8_t (*sha1_ref)[20], char (*mc_ref)[40])
+{
+	uint8_t key[16], iv[8], in[CHK_MAXLEN], out[CHK_MAXLEN], ref[CHK_MAXLEN];
+	uint8_t d[20], k14[14];
+	char    pw[24], salt[16], mc[64];
+	S_EDE2_KS ks;
+	int     it, j;
+
+	s_rng = 0x9E3779B97F4A7C15ULL;
+	for (it = 0; it < CHK_ITERS; it++)
+	{
+		size_t len = 8 * (1 + rnd32() % (CHK_MAXLEN / 8));
+		size_t hl  = rnd32() % (len + 1);
+		bool   enc = rnd32() & 1;
+
+		rnd_fill(key, 16); rnd_fill(iv, 8); rnd_fill(in, len);
+		crypt_ede2_setkey(&ks, key);
+
+		crypt_des_enc(key, in, out); crypt_des_ref_enc(key, in, ref);
+		check_mem("diff des enc", out, ref, 8);
+		crypt_des_dec(key, in, out); crypt_des_ref_dec(key, in, ref);
+		check_mem("diff des dec", out, ref, 8);
+
+		ede2_ref(key, iv, in, ref, len, true, enc);
+		crypt_ede2_cbc(key, iv, in, out, len, enc);
+		check_mem("diff ede2 cbc", out, ref, len);
+		memcpy(out, in, len);
+		crypt_ede2_cbc_ks(&ks, iv, out, out, len, enc);
+		check_mem("diff ede2 cbc_ks in-place", out, ref, len);
+
+		ede2_ref(key, iv, in, ref, len, false, enc);
+		crypt_ede2_ecb(key, in, out, len, enc);
+		check_mem("diff ede2 ecb", out, ref, len);
+		memcpy(out, in, len);
+		crypt_ede2_ecb_ks(&ks, out, out, len, enc);
+		check_mem("diff ede2 ecb_ks in-place", out, ref, len);
+
+		memcpy(k14, in, 14);
+		crypt_key_spread(k14, out); spread_ref(k14, ref);
+		check_mem("diff key_spread", out, ref, 16);
+
+		crypt_md5_hash(in, hl, d);
+		check_mem("diff md5", d, md5_ref[it], 16);
+		sha1_hash(in, hl, d);
+		check_mem("diff sha1", d, sha1_ref[it], 20);
+
+		if (it % 50 == 0)
+		{
+			for (j = 0; j < (int)sizeof(pw) - 1; j++) pw[j] = (char)('!' + rnd32() % 94);
+			pw[rnd32() % sizeof(pw)] = '\0';
+			pw[sizeof(pw) - 1] = '\0';
+			snprintf(salt, sizeof(salt), "$1$%08x$", rnd32());
+			crypt_md5_crypt(pw, salt, mc, sizeof(mc));
+			s_checks++;
+			if (strcmp(mc, mc_ref[it / 50]) != 0)
+			{
+				s_fails++;
+				fprintf(stderr, "FAIL diff md5_crypt\n    got  %s\n    want %s\n",
+				        mc, mc_ref[it / 50]);
+			}
+		}
+	}
+}
+
+static void collect_ref(uint8_t (*md5_ref)[16], uint8_t (*sha1_ref)[20], char (*mc_ref)[40])
+{
+	uint8_t key[16], iv[8], in[CHK_MAXLEN];
+	char    pw[24], salt[16], mc[64];
+	int     it, j;
+
+	s_rng = 0x9E3779B97F4A7C15ULL;
+	for (it = 0; it < CHK_ITERS; it++)
+	{
+		size_t len = 8 * (1 + rnd32() % (CHK_MAXLEN / 8));
+		size_t hl  = rnd32() % (len + 1);
+		(void)rnd32();
+		rnd_fill(key, 16); rnd_fill(iv, 8); rnd_fill(in, len);
+		crypt_md5_hash(in, hl, md5_ref[it]);
+		sha1_hash(in, hl, sha1_ref[it]);
+		if (it % 50 == 0)
+		{
+			for (j = 0; j < (int)sizeof(pw) - 1; j++) pw[j] = (char)('!' + rnd32() % 94);
+			pw[rnd32() % sizeof(pw)] = '\0';
+			pw[sizeof(pw) - 1] = '\0';
+			snprintf(salt, sizeof(salt), "$1$%08x$", rnd32());
+			crypt_md5_crypt(pw, salt, mc, sizeof(mc));
+			tcmg_strlcpy(mc_ref[it / 50], mc, sizeof(mc_ref[0]));
+		}
+	}
+}
+
+static bool use_kernel(const char *name)
+{
+	crypt_force_kernel(name);
+	crypt_init();
+	return strcmp(crypt_kernel_name(), name) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *kernels[] = { "generic", "generic-avx2build" };
+	static uint8_t md5_ref[CHK_ITERS][16], sha1_ref[CHK_ITERS][20];
+	static char    mc_ref[CHK_ITERS / 50][40];
+	size_t i;
+
+	for (int a = 1; a < argc; a++)
+		if (strcmp(argv[a], "-v") == 0) s_verbose = true;
+
+	if (!use_kernel("generic"))
+	{
+		fprintf(stderr, "FAIL generic kernel not selectable\n");
+		return 1;
+	}
+	collect_ref(md5_ref, sha1_ref, mc_ref);
+
+	for (i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+	{
+		int32_t before = s_fails;
+		if (!use_kernel(kernels[i]))
+		{
+			printf("kernel %-8s skipped (not supported on this cpu)\n", kernels[i]);
+			continue;
+		}
+		kat_des();
+		kat_ede2();
+		kat_hash();
+		kat_md5_crypt();
+		kat_chacha20();
+		kat_spread();
+		diff_kernel(md5_ref, sha1_ref, mc_ref);
+		printf("kernel %-8s %s\n", kernels[i], s_fails == before ? "ok" : "FAILED");
+	}
+
+	printf("crypto check: %d checks, %d failures\n", s_checks, s_fails);
+	return s_fails ? 1 : 0;
+}
@@ -2,6 +2,48 @@
 #include "../../globals.h"
 #include "../internal/proto.h"
 
+typedef struct {
+	char   *buf;
+	int     bsz;
+	int     pos;
+	time_t  now;
+	bool    first;
+} S_STATUS_CTX;
+
+static void status_client_json(S_CLIENT *cl, void *arg)
+{
+	S_STATUS_CTX *x   = (S_STATUS_CTX *)arg;
+	S_ACCOUNT    *acc = cl->account;
+	if (!acc) return;
+	char conn_str[32], idle_str[32];
+	char esc_user[256], esc_ip[128], esc_proto[64], esc_chan[256];
+	format_uptime(x->now - cl->connect_time,  conn_str, sizeof(conn_str));
+	format_uptime(x->now - acc->last_seen,    idle_str, sizeof(idle_str));
+	json_escape(cl->user,                              esc_user,  sizeof(esc_user));
+	json_escape(cl->ip,                               esc_ip,    sizeof(esc_ip));
+	json_escape(cl->proto,                            esc_proto, sizeof(esc_proto));
+	json_escape(cl->last_channel[0] ? cl->last_channel : "", esc_chan, sizeof(esc_chan));
+	x->pos = buf_printf(&x->buf, &x->bsz, x->pos,
+		"%s{"
+		"\"user\":\"%s\","
+		"\"ip\":\"%s\","
+		"\"proto\":\"%s\","
+		"\"caid\":\"%04X\","
+		"\"sid\":\"%04X\","
+		"\"channel\":\"%s\","
+		"\"connected\":\"%s\","
+		"\"idle\":\"%s\","
+		"\"thread_id\":%u"
+		"}",
+		x->first ? "" : ",",
+		esc_user, esc_ip, esc_proto,
+		cl->last_caid, cl->last_srvid,
+		esc_chan,
+		conn_str, idle_str,
+		cl->thread_id);
+	x->first = false;
+}
+
 void send_api_status(int fd)
 {
 	int   bsz = 16384, pos = 0;
@@ -24,51 +66,81 @@ void send_api_status(int fd)
 		"\"banned_ips\":%d,"
 		"\"cw_found\":%lld,"
 		"\"cw_not\":%lld,"
+		"\"cw_neg\":%lld,"
+		"\"cw_l1_hit\":%lld,"
+		"\"cw_l2_hit\":%lld,"
+		"\"l1_hit_rate_pct\":%.1f,"
+		"\"l2_hit_rate_pct\":%.1f,"
 		"\"ecm_total\":%lld,"
 		"\"hit_rate_pct\":%.1f,"
+		"\"io_recv_calls\":%llu,"
+		"\"io_send_calls\":%llu,"
+		"\"io_ring_enters\":%llu,"
+		"\"syscalls_per_ecm\":%.2f,"
+		"\"ecm_expired\":%llu,"
+		"\"ecm_shed\":%llu,"
+		"\"ecm_queued\":%d,"
+		"\"ecm_latency_ms\":%d,"
 		"\"debug_mask\":%u,"
-		"\"clients\":[",
+		"\"cw_caids\":[",
 		TCMG_VERSION, TCMG_BUILD_TIME,
 		(long)st.uptime_s, st.uptime_str,
 		g_cfg.newcamd_port, g_cfg.cccam_port, st.active_conns,
 		st.naccounts, st.nbans,
-		(long long)st.cw_found, (long long)st.cw_not, (long long)st.ecm_total,
-		st.hit_rate, g_dblevel);
+		(long long)st.cw_found, (long long)st.cw_not, (long long)st.cw_neg,
+		(long long)st.cw_l1_hit, (long long)st.cw_l2_hit,
+		st.l1_hit_rate, st.l2_hit_rate,
+		(long long)st.ecm_total,
+		st.hit_rate,
+		(unsigned long long)st.io_recv_calls, (unsigned long long)st.io_send_calls,
+		(unsigned long long)st.io_ring_enters, st.syscalls_per_ecm,
+		(unsigned long long)st.ecm_expired, (unsigned long long)st.ecm_shed,
+		st.ecm_queued, st.ecm_lat_ms,
+		g_dblevel);
 
-	pthread_mutex_lock(&g_clients_mtx);
-	bool first = true;
-	for (int i = 0; i < MAX_ACTIVE_CLIENTS; i++) {
-		S_CLIENT *cl = g_clients[i];
-		if (!cl || !cl->account) continue;
-		char conn_str[32], idle_str[32];
-		char esc_user[256], esc_ip[128], esc_proto[64], esc_chan[256];
-		format_uptime(now - cl->connect_time,         conn_str, sizeof(conn_str));
-		format_uptime(now - cl->account->last_seen,   idle_str, sizeof(idle_str));
-		json_escape(cl->user,                              esc_user,  sizeof(esc_user));
-		json_escape(cl->ip,                               esc_ip,    sizeof(esc_ip));
-		json_escape(cl->proto,                            esc_proto, sizeof(esc_proto));
-		json_escape(cl->last_channel[0] ? cl->last_channel : "", esc_chan, sizeof(esc_chan));
+	S_CW_CAID_INFO ci[CW_CACHE_CAIDS];
+	int32_t nci = cw_cache_caid_info(ci, CW_CACHE_CAIDS);
+	for (int32_t i = 0; i < nci; i++)
 		pos = buf_printf(&buf, &bsz, pos,
 			"%s{"
-			"\"user\":\"%s\","
-			"\"ip\":\"%s\","
-			"\"proto\":\"%s\","
 			"\"caid\":\"%04X\","
-			"\"sid\":\"%04X\","
-			"\"channel\":\"%s\","
-			"\"connected\":\"%s\","
-			"\"idle\":\"%s\","
-			"\"thread_id\":%u"
+			"\"ttl\":%d,"
+			"\"period_s\":%d,"
+			"\"lifetime_s\":%d,"
+			"\"samples\":%u,"
+			"\"lookups\":%llu,"
+			"\"hits\":%llu,"
+			"\"misses\":%llu,"
+			"\"coalesced\":%llu,"
+			"\"negative\":%llu,"
+			"\"expired\":%llu,"
+			"\"evictions\":%llu,"
+			"\"lock_wait_us\":%llu"
 			"}",
-			first ? "" : ",",
-			esc_user, esc_ip, esc_proto,
-			cl->last_caid, cl->last_srvid,
-			esc_chan,
-			conn_str, idle_str,
-			cl->thread_id);
-		first = false;
-	}
-	pthread_mutex_unlock(&g_clients_mtx);
+			i ? "," : "",
+			ci[i].caid, ci[i].ttl, ci[i].period_s, ci[i].lifetime_s, ci[i].samples,
+			(unsigned long long)ci[i].lookups, (unsigned long long)ci[i].hits,
+			(unsigned long long)ci[i].misses, (unsigned long long)ci[i].coalesced,
+			(unsigned long long)ci[i].negative,
+			(unsigned long long)ci[i].expired,
+			(unsigned long long)ci[i].evictions, (unsigned long long)ci[i].lock_wait_us);
+
+	S_CW_SHARD_INFO si[256];
+	int32_t nsi = cw_cache_shard_info(si, 256);
+	pos = buf_printf(&buf, &bsz, pos, "],\"cw_shards\":[");
+	for (int32_t i = 0; i < nsi; i++)
+		pos = buf_printf(&buf, &bsz, pos,
+			"%s{\"locks\":%llu,\"contended\":%llu,\"wait_us\":%llu}",
+			i ? "," : "",
+			(unsigned long long)si[i].locks, (unsigned long long)si[i].contended,
+			(unsigned long long)si[i].wait_us);
+	pos = buf_printf(&buf, &bsz, pos, "],\"clients\":[");
+
+	S_STATUS_CTX x = { buf, bsz, pos, now, true };
+	clients_foreach(status_client_json, &x);
+	buf = x.buf;
+	bsz = x.bsz;
+	pos = x.pos;
 
 	pos = buf_printf(&buf, &bsz, pos, "]}");
 	send_response(fd, 200, "OK", "application/json", buf, pos);
@@ -117,6 +117,7 @@ void handle_user_save(int fd, const char *post_body)
 		a->expirationdate = 0;
 	}
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	auth_cache_flush();
 
 	if (!cfg_save(&g_cfg)) {
 		send_json_error(fd, 500, "Internal Error", "failed to save config");
@@ -145,7 +146,7 @@ void handle_user_delete(int fd, const char *qs)
 		if (strcmp((*pp)->user, uname) == 0) {
 			S_ACCOUNT *del = *pp;
 			*pp = del->next;
-			free(del);
+			cfg_account_release(del);
 			g_cfg.naccounts--;
 			found = 1;
 			break;
@@ -153,6 +154,8 @@ void handle_user_delete(int fd, const char *qs)
 		pp = &(*pp)->next;
 	}
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	atomic_fetch_add(&g_acc_gen, 1);
+	auth_cache_flush();
 
 	if (!found) {
 		send_json_error(fd, 404, "Not Found", "user not found");
@@ -246,6 +249,9 @@ void handle_user_resetstats(int fd, const char *qs)
 	a->ecm_total        = 0;
 	a->cw_found         = 0;
 	a->cw_not           = 0;
+	a->cw_neg           = 0;
+	a->cw_l1_hit        = 0;
+	a->cw_l2_hit        = 0;
 	a->cw_time_total_ms = 0;
 	a->cw_time_min_ms   = 0;
 	a->cw_time_max_ms   = 0;
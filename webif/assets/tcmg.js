@@ -96,15 +96,42 @@ function _upd_status(d) {
   _anim('p_acc',  d.accounts);
   _anim('p_hit',  _fmt(d.cw_found));
   _anim('p_miss', _fmt(d.cw_not));
+  _anim('p_neg',  _fmt(d.cw_neg));
+  _anim('p_l1',   d.l1_hit_rate_pct.toFixed(1) + '%%');
+  _anim('p_l2',   d.l2_hit_rate_pct.toFixed(1) + '%%');
   _anim('p_ban',  d.banned_ips);
   _anim('p_ecm',  _fmt(d.ecm_total));
 
+  var sp = document.getElementById('p_spe');
+  if (sp) sp.textContent = d.syscalls_per_ecm.toFixed(2);
+
   var hr = document.getElementById('p_hr');
   if (hr) hr.textContent = d.hit_rate_pct.toFixed(1) + '%%';
 
   var hb = document.getElementById('p_hbf');
   if (hb) hb.style.width = d.hit_rate_pct.toFixed(0) + '%%';
 
+  var ct = document.getElementById('p_caids');
+  if (ct && d.cw_caids) {
+    ct.innerHTML = d.cw_caids.length ? d.cw_caids.map(function(c) {
+      return '<tr>'
+        + '<td class="mono"><span class="badge bbl">' + _esc(c.caid) + '</span></td>'
+        + '<td class="mono bold">' + c.ttl + 's</td>'
+        + '<td class="mono tm">' + c.period_s + 's</td>'
+        + '<td class="mono tm">' + c.lifetime_s + 's</td>'
+        + '<td class="mono">' + c.samples + '</td>'
+        + '<td class="mono">' + _fmt(c.lookups) + '</td>'
+        + '<td class="mono tg">' + _fmt(c.hits) + '</td>'
+        + '<td class="mono">' + _fmt(c.misses) + '</td>'
+        + '<td class="mono">' + _fmt(c.coalesced) + '</td>'
+        + '<td class="mono">' + _fmt(c.negative) + '</td>'
+        + '<td class="mono">' + _fmt(c.expired) + '</td>'
+        + '<td class="mono' + (c.evictions > 0 ? ' to' : '') + '">' + _fmt(c.evictions) + '</td>'
+        + '<td class="mono tm">' + Math.floor(c.lock_wait_us / 1000) + 'ms</td>'
+        + '</tr>';
+    }).join('') : '<tr class="erow"><td colspan="13">No ECMs seen yet</td></tr>';
+  }
+
   var tb = document.getElementById('p_clients');
   if (!tb) return;
 
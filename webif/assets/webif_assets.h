@@ -0,0 +1,29 @@
+/* webif_assets.h — AUTO-GENERATED by tools/gen_assets.py
+ *
+ * DO NOT EDIT by hand.  Run:
+ *   python3 tools/gen_assets.py
+ * or use:
+ *   make assets
+ *
+ * TCMG_CSS  : full stylesheet — use as %s arg in buf_printf
+ * TCMG_JS   : runtime JS     — use as format string in buf_printf
+ *             (contains intentional %d / %% printf specifiers)
+ */
+#ifndef TCMG_WEBIF_ASSETS_H_
+#define TCMG_WEBIF_ASSETS_H_
+
+/* tcmg.css — 22516 bytes */
+#define TCMG_CSS \
+"@import url('https://fonts.googleapis.com/css2?family=JetBrains+Mono:wght@400;500;700&family=Space+Grotesk:wght@300;400;500;600;700&display=swap');*{box-sizing:border-box;margin:0;padding:0}html{scroll-behavior:smooth}a{text-decoration:none;color:inherit}button{cursor:pointer;font-family:inherit;border:none;background:none}ul,ol{list-style:none}:root{--bg:#090d14;--s1:#0e1421;--s2:#141c2e;--s3:#1a2340;--s4:#202b47;--bd:#1e2d47;--bd2:#253554;--p:#3b82f6;--p2:#2563eb;--ps:rgba(59,130,246,.10);--pg:rgba(59,130,246,.22);--vi:#8b5cf6;--vis:rgba(139,92,246,.10);--vig:rgba(139,92,246,.22);--cy:#06b6d4;--cys:rgba(6,182,212,.10);--cyg:rgba(6,182,212,.22);--gr:#22c55e;--grs:rgba(34,197,94,.10);--grg:rgba(34,197,94,.22);--re:#ef4444;--res:rgba(239,68,68,.10);--or:#f97316;--or2:#fb923c;--ors:rgba(249,115,22,.10);--t0:#e8f0fe;--t1:#94a3b8;--t2:#4b6584;--sans:'Space Grotesk',sans-serif;--mono:'JetBrains Mono',monospace;--r:10px;--rsm:6px;--rxs:4px;--tbh:56px;--ease:cubic-bezier(.4,0,.2,1);}body{background:var(--bg);color:var(--t0);font-family:var(--sans);font-size:14px;line-height:1.5;-webkit-font-smoothing:antialiased;}#tb{position:fixed;top:0;left:0;right:0;height:var(--tbh);background:var(--s1);border-bottom:1px solid var(--bd);display:flex;align-items:center;padding:0 18px;z-index:1030;gap:10px;}.lo{display:flex;align-items:center;gap:9px;margin-right:10px;flex-shrink:0}.li{width:30px;height:30px;background:var(--ps);border:1px solid var(--pg);border-radius:8px;display:grid;place-items:center;flex-shrink:0}.li svg{width:16px;height:16px}.lt{font-weight:700;font-size:14px;letter-spacing:.06em;color:var(--t0)}.lv{font-family:var(--mono);font-size:10px;color:var(--p);background:var(--ps);border:1px solid var(--pg);padding:1px 6px;border-radius:var(--rxs)}.tnav{display:flex;align-items:center;justify-content:center;gap:2px;flex:1;flex-wrap:wrap}.tnav a{display:inline-flex;align-items:center;gap:5px;padding:6px 10px;border-radius:var(--rsm);color:var(--t1);font-size:12.5px;font-weight:500;border:1px solid transparent;transition:background .15s,color .15s,border-color .15s;white-space:nowrap}.tnav a:hover{background:var(--s3);color:var(--t0)}.tnav a.act{background:var(--ps);color:var(--p);border-color:var(--pg)}.tnav .ni{width:14px;height:14px;flex-shrink:0;opacity:.75}.tnav a.act .ni,.tnav a:hover .ni{opacity:1}.tnav .sep{width:1px;height:20px;background:var(--bd2);margin:0 4px;flex-shrink:0}.tbr{display:flex;align-items:center;gap:8px;margin-left:auto;flex-shrink:0}.spill{display:flex;align-items:center;gap:6px;background:var(--grs);border:1px solid rgba(34,197,94,.2);border-radius:20px;padding:3px 10px;font-size:11px;color:var(--gr);font-weight:500;white-space:nowrap}.chip{font-size:11px;font-family:var(--mono);background:var(--s2);border:1px solid var(--bd);border-radius:var(--rxs);padding:2px 8px;color:var(--t1)}.pc{display:flex;align-items:center;gap:3px;background:var(--s2);border:1px solid var(--bd);border-radius:var(--rsm);padding:3px 7px;font-size:10px;font-family:var(--mono);color:var(--t2)}.pc label{white-space:nowrap;letter-spacing:.05em}.pc input{width:28px;background:none;border:none;outline:none;color:var(--t0);font-family:var(--mono);font-size:12px;text-align:center}.pc button{color:var(--t2);font-size:13px;line-height:1;padding:0 2px;border-radius:3px}.pc button:hover{color:var(--t0);background:var(--s3)}body.pg-config .pc,body.pg-users .pc,body.pg-failban .pc,body.pg-tvcas .pc,body.pg-power .pc{display:none}.pc.pc-off{display:none}.pulse{width:8px;height:8px;border-radius:50%;background:var(--gr);flex-shrink:0;animation:pa 2s ease-in-out infinite}.pulse.sm{width:6px;height:6px}@keyframes pa{0%{box-shadow:0 0 0 0 rgba(34,197,94,.5)}70%{box-shadow:0 0 0 6px rgba(34,197,94,0)}100%{box-shadow:0 0 0 0 rgba(34,197,94,0)}}#mn{margin-top:var(--tbh);min-height:calc(100vh - var(--tbh));display:flex;justify-content:center}#ct{width:100%;max-width:1400px;padding:16px 20px 32px}.ph{display:flex;align-items:center;justify-content:center;" \
+"flex-wrap:wrap;gap:8px;margin-bottom:16px}.ha{display:flex;gap:8px;align-items:center}.btn{display:inline-flex;align-items:center;justify-content:center;gap:6px;padding:8px 16px;border-radius:var(--rsm);font-family:var(--sans);font-size:13px;font-weight:600;letter-spacing:.02em;transition:all .18s;cursor:pointer;border:1px solid transparent}.btn svg{width:14px;height:14px;flex-shrink:0}.bp{background:var(--p);color:#fff;border-color:var(--p)}.bp:hover{background:var(--p2);box-shadow:0 0 0 3px var(--pg)}.bg{background:var(--s2);color:var(--t1);border-color:var(--bd)}.bg:hover{background:var(--s3);color:var(--t0)}.bd_{background:var(--res);color:var(--re);border-color:rgba(239,68,68,.3)}.bd_:hover{background:rgba(239,68,68,.2)}.bwarn{background:var(--ors);color:var(--or);border-color:rgba(249,115,22,.3)}.bwarn:hover{background:rgba(249,115,22,.2)}.btn.sm{padding:5px 11px;font-size:12px}.cg{display:grid;grid-template-columns:repeat(auto-fill,minmax(200px,1fr));gap:14px;margin-bottom:16px;align-items:stretch}.sc{background:var(--s1);border:1px solid var(--bd);border-radius:var(--r);padding:16px;display:flex;align-items:flex-start;gap:14px;position:relative;overflow:hidden;transition:border-color .22s,transform .18s,box-shadow .22s;animation:fu .35s var(--ease) both;height:100%}.sc:hover{transform:none}.sc.bl{border-color:rgba(59,130,246,.28);background:rgba(59,130,246,.04)}.sc.bl:hover{border-color:var(--p);box-shadow:0 0 32px rgba(59,130,246,.14)}.sc.gr{border-color:rgba(34,197,94,.28);background:rgba(34,197,94,.04)}.sc.gr:hover{border-color:var(--gr);box-shadow:0 0 32px rgba(34,197,94,.14)}.sc.vi{border-color:rgba(139,92,246,.28);background:rgba(139,92,246,.04)}.sc.vi:hover{border-color:var(--vi);box-shadow:0 0 32px rgba(139,92,246,.14)}.sc.cy{border-color:rgba(6,182,212,.28);background:rgba(6,182,212,.04)}.sc.cy:hover{border-color:var(--cy);box-shadow:0 0 32px rgba(6,182,212,.14)}.sc.re{border-color:rgba(239,68,68,.28);background:rgba(239,68,68,.04)}.sc.re:hover{border-color:var(--re);box-shadow:0 0 32px rgba(239,68,68,.14)}.sc.or{border-color:rgba(249,115,22,.28);background:rgba(249,115,22,.04)}.sc.or:hover{border-color:var(--or);box-shadow:0 0 32px rgba(249,115,22,.14)}.si_{width:44px;height:44px;border-radius:9px;display:grid;place-items:center;flex-shrink:0}.si_ svg{width:22px;height:22px}.bl .si_{background:var(--ps);color:var(--p)}.gr .si_{background:var(--grs);color:var(--gr)}.vi .si_{background:var(--vis);color:var(--vi)}.cy .si_{background:var(--cys);color:var(--cy)}.re .si_{background:var(--res);color:var(--re)}.or .si_{background:var(--ors);color:var(--or)}.sb_{display:flex;flex-direction:column;gap:3px;min-width:0;flex:1}.sl_{font-size:10px;font-weight:700;text-transform:uppercase;letter-spacing:.10em;color:var(--t1)}.sv{font-size:22px;font-weight:700;color:var(--t0);font-variant-numeric:tabular-nums;transition:color .3s}.sv.mono{font-family:var(--mono);font-size:16px}.sd{font-size:11px;font-family:var(--mono);color:var(--t1)}.bl .sd{color:var(--p)}.gr .sd{color:var(--gr)}.vi .sd{color:var(--vi)}.cy .sd{color:var(--cy)}.re .sd{color:var(--re)}.or .sd{color:var(--or)}.gr .sv{color:var(--gr)}.re .sv{color:var(--re)}.or .sv{color:var(--or)}.vi .sv{color:var(--vi)}.cy .sv{color:var(--cy)}.bl .sv{color:var(--p)}.sc::before{content:'';position:absolute;top:0;left:0;right:0;height:2px;opacity:0;transition:opacity .22s;border-radius:var(--r) var(--r) 0 0}.sc:hover::before{opacity:1}.bl::before{background:linear-gradient(90deg,var(--p),var(--cy))}.gr::before{background:linear-gradient(90deg,var(--gr),var(--cy))}.vi::before{background:linear-gradient(90deg,var(--vi),var(--p))}.cy::before{background:linear-gradient(90deg,var(--cy),var(--vi))}.re::before{background:linear-gradient(90deg,var(--re),var(--or))}.or::before{background:linear-gradient(90deg,var(--or),var(--re))}.sg{position:absolute;width:70px;height:70px;border-radius:50%;right:-15px;top:-15px;opacity:.12;filter:blur(18px);pointer-events:none}.bl .sg{background:var(" \
+"--p)}.gr .sg{background:var(--gr)}.vi .sg{background:var(--vi)}.cy .sg{background:var(--cy)}.re .sg{background:var(--re)}.or .sg{background:var(--or)}.sc:nth-child(1){animation-delay:.04s}.sc:nth-child(2){animation-delay:.08s}.sc:nth-child(3){animation-delay:.12s}.sc:nth-child(4){animation-delay:.16s}.sc:nth-child(5){animation-delay:.20s}.sc:nth-child(6){animation-delay:.24s}.sc:nth-child(7){animation-delay:.28s}.card{background:var(--s1);border:1px solid var(--bd);border-radius:var(--r);transition:border-color .2s;animation:fu .35s var(--ease) .12s both}.card:hover{border-color:var(--pg)}.ch{display:flex;align-items:center;justify-content:space-between;padding:13px 18px;border-bottom:1px solid var(--bd);background:var(--s2);border-radius:var(--r) var(--r) 0 0}.ct{font-size:14px;font-weight:700;color:var(--t0);display:flex;align-items:center;gap:8px}.ct svg{width:16px;height:16px;color:var(--p);flex-shrink:0}.cb{padding:16px 18px}.shd{display:flex;align-items:center;justify-content:space-between;margin-bottom:12px;margin-top:4px}.stl{font-size:14px;font-weight:700;color:var(--t0);display:flex;align-items:center;gap:8px}.stl::before{content:'';display:inline-block;width:3px;height:14px;background:var(--p);border-radius:2px}.tw{border:1px solid var(--bd);border-radius:var(--r);overflow:auto;margin-bottom:16px}table{width:100%;border-collapse:collapse;font-size:13px}thead tr{background:var(--s2)}th{padding:9px 14px;text-align:left;font-size:10px;font-weight:700;text-transform:uppercase;letter-spacing:.10em;color:var(--t2);border-bottom:1px solid var(--bd);white-space:nowrap}td{padding:10px 14px;border-bottom:1px solid var(--bd);color:var(--t0)}tbody tr:last-child td{border-bottom:none}tbody tr:hover{background:var(--s3)}tbody tr.nw{animation:rf .5s ease}@keyframes rf{from{background:rgba(59,130,246,.18)}to{background:transparent}}.mono{font-family:var(--mono);font-size:12px}.bold{font-weight:600}.badge{display:inline-flex;align-items:center;gap:4px;padding:2px 9px;border-radius:var(--rxs);font-size:11px;font-weight:700;font-family:var(--mono);letter-spacing:.04em}.bon{background:var(--grs);color:var(--gr);border:1px solid rgba(34,197,94,.22)}.boff{background:var(--res);color:var(--re);border:1px solid rgba(239,68,68,.22)}.bban{background:var(--ors);color:var(--or2);border:1px solid rgba(249,115,22,.22)}.bbl{background:var(--ps);color:var(--p);border:1px solid var(--pg)}.bcy{background:var(--cys);color:var(--cy);border:1px solid var(--cyg)}.kb{display:inline-flex;align-items:center;padding:4px 7px;border-radius:var(--rxs);color:var(--re);opacity:.4;transition:opacity .15s,background .15s}.kb:hover{opacity:1;background:var(--res)}.kb svg{width:13px;height:13px}.pw-btn{display:inline-flex;align-items:center;justify-content:center;width:28px;height:28px;border-radius:6px;border:none;cursor:pointer;transition:all .15s;padding:0}.pw-btn svg{width:15px;height:15px;pointer-events:none}.pw-btn.on{background:rgba(74,222,128,.15);color:#4ade80}.pw-btn.off{background:var(--s3);color:var(--t2);opacity:.5}.pw-btn:hover{opacity:1!important;filter:brightness(1.2)}.u-link{cursor:pointer;color:var(--t1)}.u-link:hover{color:var(--p);text-decoration:underline}.ctab{padding:7px 16px;font-size:12px;font-weight:600;letter-spacing:.05em;border:1px solid var(--bd);border-bottom:none;border-radius:6px 6px 0 0;background:var(--s2);color:var(--t2);cursor:pointer;transition:all .15s}.ctab.act{background:var(--ps);color:var(--p);border-color:var(--pg);border-bottom:2px solid var(--p)}.ctab:not(.act):hover{color:var(--t0);background:var(--s3)}.hbw{background:var(--s3);border-radius:4px;height:5px;width:80px;overflow:hidden}.hbf{height:100%;border-radius:4px;background:linear-gradient(90deg,var(--gr),var(--cy));transition:width .4s}.lc{display:flex;align-items:center;justify-content:center;gap:8px;margin-bottom:12px;flex-wrap:wrap}.ls{background:var(--s2);border:1px solid var(--bd2);color:var(--t0);border-radius:var(--rsm);padding:5px 10px;font-family:var(--mon" \
+"o);font-size:12px;width:220px;outline:none}.ls:focus{border-color:var(--pg)}select.lsel{background:var(--s2);color:var(--t1);border:1px solid var(--bd2);border-radius:var(--rsm);padding:5px 8px;font-size:12px}#lw{background:#030b14;border:1px solid var(--bd);border-radius:var(--r);height:calc(100vh - 310px);min-height:320px;overflow:auto;padding:14px 4px 14px 14px;position:relative;scroll-behavior:smooth}#lw::before{content:'LIVE';position:absolute;top:10px;right:12px;font-size:9px;font-family:var(--mono);font-weight:700;letter-spacing:.12em;color:var(--gr);opacity:.4;pointer-events:none}#lp{margin:0;font-family:var(--mono);font-size:12.5px;line-height:1.85;color:var(--t1)}#lp span{display:block;white-space:pre;border-radius:2px;padding:0 4px}#lp span:hover{background:rgba(255,255,255,0.04)}.lok{color:#4ade80;font-weight:700}.lwarn{color:var(--or2);font-weight:700}.lerr{color:var(--re);font-weight:700}.lnet{color:#c084fc;font-weight:700}.lwebif{color:#60a5fa;font-weight:700}.lban{color:var(--or2);font-weight:700}.lt2{color:var(--t2)}.db{background:var(--s2);border:1px solid var(--bd);border-radius:var(--rsm);padding:8px 12px;margin-bottom:12px;display:flex;flex-wrap:wrap;align-items:center;justify-content:center;gap:5px}.dt{display:inline-flex;align-items:center;padding:3px 10px;border-radius:var(--rxs);font-size:11px;font-family:var(--mono);font-weight:500;cursor:pointer;border:1px solid var(--bd);color:var(--t2);transition:all .15s;user-select:none}.dt.on{background:var(--ps);border-color:var(--pg);color:var(--p)}.dt:hover{border-color:var(--pg);color:var(--p)}.dm{font-size:11px;color:var(--t2);font-family:var(--mono)}.et{display:flex;align-items:center;justify-content:center;gap:10px;padding:10px 16px;border-bottom:1px solid var(--bd);background:var(--s2);border-radius:var(--r) var(--r) 0 0}.ef{font-family:var(--mono);font-size:12px;color:var(--p);display:flex;align-items:center;gap:8px}.ef svg{width:14px;height:14px;opacity:.6}.ew{background:var(--ors);border-top:1px solid rgba(249,115,22,.25);padding:7px 16px;font-family:var(--mono);font-size:12px;color:var(--or2);display:flex;align-items:center;gap:6px}.ew svg{width:13px;height:13px;flex-shrink:0}.ea{font-family:var(--mono);font-size:13px;line-height:1.9;color:#a5d6a7;background:#040810;border:none;outline:none;width:100%;min-height:390px;padding:14px 16px;resize:vertical}.ef2{display:flex;align-items:center;justify-content:center;gap:10px;padding:8px 16px;border-top:1px solid var(--bd);background:var(--s2);border-radius:0 0 var(--r) var(--r)}.es{font-family:var(--mono);font-size:11px;color:var(--t1);text-align:center}.es .ok{color:var(--gr)}.lb{min-height:100vh;display:flex;align-items:center;justify-content:center;background:var(--bg);background-image:radial-gradient(ellipse at 20% 50%,rgba(59,130,246,.06) 0%,transparent 60%),radial-gradient(ellipse at 80% 20%,rgba(6,182,212,.06) 0%,transparent 60%)}.lcard{background:var(--s2);border:1px solid var(--bd);border-radius:14px;padding:30px 36px;width:350px;box-shadow:0 28px 70px rgba(0,0,0,.55)}.ll{display:flex;align-items:center;gap:12px;margin-bottom:24px}.lli{width:46px;height:46px;background:var(--ps);border:1px solid var(--pg);border-radius:11px;display:grid;place-items:center;flex-shrink:0}.lli svg{width:26px;height:26px}.llt{font-size:20px;font-weight:700;color:var(--t0)}.llv{font-size:11px;color:var(--t1);font-family:var(--mono);margin-top:2px}.fld{display:block;font-size:11px;font-weight:600;color:var(--t1);letter-spacing:.05em;margin-bottom:5px}.fi{width:100%;padding:9px 12px;background:var(--s1);border:1px solid var(--bd);color:var(--t0);border-radius:var(--rsm);font-size:13px;font-family:var(--sans);transition:border-color .18s;outline:none}.fi:focus{border-color:var(--pg)}.fg{margin-bottom:14px}.le{display:flex;align-items:center;gap:8px;background:var(--res);border:1px solid rgba(239,68,68,.28);border-radius:var(--rsm);padding:9px 12px;color:var(--re);font-size:12px;margin-bottom:16px}.le svg{width:14px;height" \
+":14px;flex-shrink:0}.dlg{background:var(--s2);border:1px solid var(--bd);border-radius:14px;padding:32px;max-width:460px}.dico{width:60px;height:60px;border-radius:14px;display:grid;place-items:center;margin:0 auto 18px;flex-shrink:0}.dico svg{width:30px;height:30px}.dico.danger{background:var(--res);color:var(--re)}.dico.info{background:var(--ps);color:var(--p)}.dico.warn{background:var(--ors);color:var(--or)}.dlg h2{font-size:17px;font-weight:700;color:var(--t0);text-align:center;margin-bottom:8px}.dlg p{color:var(--t1);font-size:13px;text-align:center;margin-bottom:16px;line-height:1.6}.da{display:flex;gap:10px;justify-content:center;flex-wrap:wrap}.done-card{background:var(--s2);border:1px solid var(--bd);border-radius:14px;padding:32px;max-width:400px;text-align:center}.pg-center{display:flex;justify-content:center;padding-top:20px}.ib2{background:var(--s2);border:1px solid var(--bd);border-radius:var(--rsm);padding:10px 14px;margin-bottom:12px;font-size:12px;color:var(--t1)}.ib2 svg{width:13px;height:13px;vertical-align:-2px;margin-right:4px}.tg{color:var(--gr)}.tr{color:var(--re)}.to{color:var(--or2)}.tb{color:var(--p)}.tv{color:var(--vi)}.tc{color:var(--cy)}.tm{color:var(--t1)}.flex{display:flex;align-items:center}.gap8{gap:8px}.gap10{gap:10px}.mb16{margin-bottom:16px}.mb10{margin-bottom:10px}a.danger{color:var(--re)}hr{border:none;border-top:1px solid var(--bd);margin:14px 0}.erow td{text-align:center;color:var(--t1);padding:22px}input[type=checkbox]{accent-color:var(--p)}label{cursor:pointer}.tip{position:relative}.tipt{display:none;position:absolute;bottom:calc(100% + 6px);left:50%;transform:translateX(-50%);background:var(--s4);border:1px solid var(--bd2);border-radius:5px;padding:4px 8px;font-size:11px;color:var(--t0);white-space:nowrap;z-index:300;pointer-events:none}.tip:hover .tipt{display:block}@keyframes fu{from{opacity:0;transform:translateY(10px)}to{opacity:1;transform:translateY(0)}}@keyframes cnt{from{opacity:0;transform:scale(.85)}to{opacity:1;transform:scale(1)}}.cnt-up{animation:cnt .4s var(--ease)}::-webkit-scrollbar{width:5px;height:5px}::-webkit-scrollbar-track{background:transparent}::-webkit-scrollbar-thumb{background:var(--bd2);border-radius:4px}::-webkit-scrollbar-thumb:hover{background:var(--bd)}th.sortable{cursor:pointer;user-select:none;position:relative}th.sortable:hover{color:var(--t0);background:rgba(59,130,246,.08)}th.sort-asc::after{content:' \\u2191';color:var(--p)}th.sort-desc::after{content:' \\u2193';color:var(--p)}.ttb{display:flex;align-items:center;justify-content:center;gap:10px;margin-bottom:12px;flex-wrap:wrap}.ttb-r{display:flex;gap:8px;align-items:center}.tsrch{background:var(--s2);border:1px solid var(--bd2);color:var(--t0);border-radius:var(--rsm);padding:6px 12px;font-family:var(--mono);font-size:12px;width:160px;outline:none;transition:border-color .18s}.tsrch:focus{border-color:var(--pg)}.tsrch::placeholder{color:var(--t2)}tfoot tr{background:var(--s2)}tfoot td{padding:9px 14px;font-size:11px;font-weight:700;color:var(--t2);border-top:2px solid var(--bd);letter-spacing:.04em}tfoot .tfs{font-size:13px;color:var(--t0)}tfoot .tfl{font-size:10px;color:var(--t2);text-transform:uppercase;letter-spacing:.1em}.sbar{display:grid;grid-template-columns:repeat(auto-fit,minmax(120px,1fr));border:1px solid var(--bd);border-radius:var(--r);overflow:hidden;margin-bottom:16px;background:var(--s1);max-width:660px;margin-left:auto;margin-right:auto}.sbar-item{padding:12px 16px;border-right:1px solid var(--bd);display:flex;flex-direction:column;gap:3px;transition:background .18s}.sbar-item:last-child{border-right:none}.sbar-item:hover{background:var(--s2)}.sbl{font-size:9px;font-weight:700;text-transform:uppercase;letter-spacing:.12em;color:var(--t2)}.sbv{font-size:18px;font-weight:700;color:var(--t0);font-variant-numeric:tabular-nums}.sbv.sm{font-size:13px;font-family:var(--mono)}.sbv.tg{color:var(--gr)}.sbv.tr{color:var(--re)}.sbv.tb{color:var(--p)}.sbv.to{color:var(--or2)}.row2{display:g" \
+"rid;grid-template-columns:1fr 1fr;gap:14px;margin-bottom:16px}.row2.r7030{grid-template-columns:7fr 3fr}.row2.r6040{grid-template-columns:6fr 4fr}@media(max-width:900px){.row2,.row2.r7030,.row2.r6040{grid-template-columns:1fr}}.ecm-bk{display:flex;gap:2px;height:6px;border-radius:4px;overflow:hidden;margin:6px 0 2px;width:100%;background:var(--s3)}.ecm-bk span{height:100%;transition:width .4s}.ecm-ok{background:var(--gr)}.ecm-nok{background:var(--re)}.msr{display:flex;flex-wrap:wrap;gap:8px 16px;font-size:12px;font-family:var(--mono)}.msr-kv{display:flex;gap:5px;align-items:center}.msr-k{color:var(--t2);font-size:10px;text-transform:uppercase;letter-spacing:.08em;font-family:var(--sans);font-weight:600}.msr-v{color:var(--t0);font-weight:600}#mnuBtn{display:none;width:34px;height:34px;border-radius:var(--rsm);background:var(--s2);border:1px solid var(--bd);place-items:center;color:var(--t1);cursor:pointer;flex-shrink:0}#mnuBtn svg{width:16px;height:16px}@media(max-width:780px){  #mnuBtn{display:grid}  .tnav{display:none;position:fixed;top:var(--tbh);left:0;right:0;bottom:0;    background:rgba(9,13,20,.97);z-index:1020;flex-direction:column;padding:14px;    overflow-y:auto;gap:4px}  .tnav.open{display:flex}  .tnav .sep{display:none}  .tnav a{font-size:14px;padding:10px 14px}  .tbr .chip,.tbr .pc{display:none}}.ll-meta{display:flex;align-items:center;gap:5px;font-size:11px;font-family:var(--mono);color:var(--t2)}.ll-dot{width:7px;height:7px;border-radius:50%;background:var(--gr);animation:pa 2s ease-in-out infinite;flex-shrink:0}.ll-mask{color:var(--p)}.ll-row{display:flex;flex-wrap:wrap;align-items:center;gap:6px;justify-content:center}.ll-label{font-size:10px;font-weight:700;text-transform:uppercase;letter-spacing:.1em;color:var(--t2);white-space:nowrap}.ll-sep{width:1px;height:18px;background:var(--bd2);flex-shrink:0}.ll-chk{display:flex;align-items:center;font-size:12px;color:var(--t1);white-space:nowrap;gap:4px;cursor:pointer}.ll-toolbar{padding:4px 0}.ll-ch{display:flex;flex-direction:column;align-items:center;padding:13px 18px;border-bottom:1px solid var(--bd);background:var(--s2);border-radius:var(--r) var(--r) 0 0;gap:8px}.ll-hdr-right{display:flex;align-items:center;gap:5px;flex-wrap:wrap;justify-content:center}.ll-dbrow{display:flex;align-items:center;gap:5px;flex-wrap:wrap;justify-content:center}.ll-vsep{width:1px;height:18px;background:var(--bd2);flex-shrink:0;margin:0 4px}.ll-toolbar2{display:flex;flex-wrap:wrap;align-items:center;gap:6px;justify-content:center}\n"
+
+/* tcmg.js — 6990 bytes */
+#define TCMG_JS \
+"/* tcmg.js — shared WebIF runtime\n *\n * NOTE: This file contains printf format specifiers (%d, %%) because it is\n * embedded into the HTML response via buf_printf() in webif_layout.c.\n * Do NOT remove the %% sequences — they produce literal % in HTML output.\n * The %d near the top is replaced at runtime with the configured poll interval.\n *\n * Sections:\n *   1. Mobile nav toggle\n *   2. Poll interval control\n *   3. Utility helpers (format, escape, animate)\n *   4. Topbar updater\n *   5. Status page updater (client table + stat cards)\n *   6. Kill-client handler\n *   7. Poll loop\n */\n\n/* 1. Mobile nav toggle */\ndocument.querySelectorAll('.tnav a').forEach(function(a) {\n  a.addEventListener('click', function() {\n    document.querySelector('.tnav').classList.remove('open');\n  });\n});\n\n/* 2. Poll interval control — initial value comes from server config */\nvar _pm = (function() {\n  var srv = %d;\n  if (srv <= 0) return 0;\n  var stored = parseInt(sessionStorage.tcmg_poll);\n  var v = (stored >= 1 && stored <= 99) ? stored : srv;\n  var el = document.getElementById('ps_');\n  if (el) el.value = v;\n  return v * 1000;\n})();\n\nvar _pit = null, _busy = false, _ut = 0, _ut_tmr = null;\n\nfunction _ap(d) {\n  if (_pm === 0) return;\n  var el = document.getElementById('ps_');\n  var v = Math.max(1, Math.min(99, parseInt(el.value) || 5) + d);\n  el.value = v;\n  _pm = v * 1000;\n  sessionStorage.tcmg_poll = v;\n  if (_pit) { clearInterval(_pit); _pit = setInterval(_poll, _pm); }\n}\n\n/* 3. Utility helpers */\nfunction _fmt_up(s) {\n  var h = Math.floor(s / 3600), m = Math.floor((s %% 3600) / 60), sc = s %% 60;\n  return (h > 0 ? String(h).padStart(2, '0') + 'h ' : '')\n    + String(m).padStart(2, '0') + 'm '\n    + String(sc).padStart(2, '0') + 's';\n}\n\nfunction _esc(s) {\n  return String(s).replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');\n}\n\nfunction _fmt(n) {\n  return n >= 1e6 ? (n / 1e6).toFixed(1) + 'M'\n       : n >= 1e3 ? (n / 1e3).toFixed(1) + 'K'\n       : String(n);\n}\n\nfunction _anim(id, v) {\n  var e = document.getElementById(id);\n  if (!e) return;\n  if (e.textContent === String(v)) return;\n  e.textContent = v;\n  e.classList.remove('cnt-up');\n  void e.offsetWidth;\n  e.classList.add('cnt-up');\n}\n\n/* 4. Topbar updater */\nfunction _upd_topbar(d) {\n  var e = document.getElementById('tb_conn');\n  if (e) e.textContent = d.active_connections;\n}\n\n/* 5. Status page updater */\nfunction _upd_status(d) {\n  _ut = d.uptime_s | 0;\n  if (!_ut_tmr) {\n    _ut_tmr = setInterval(function() {\n      _ut++;\n      var e = document.getElementById('p_up');\n      if (e) e.textContent = _fmt_up(_ut);\n    }, 1000);\n  }\n  var eu = document.getElementById('p_up');\n  if (eu) eu.textContent = _fmt_up(_ut);\n\n  _anim('p_conn', d.active_connections);\n  _anim('p_acc',  d.accounts);\n  _anim('p_hit',  _fmt(d.cw_found));\n  _anim('p_miss', _fmt(d.cw_not));\n  _anim('p_neg',  _fmt(d.cw_neg));\n  _anim('p_l1',   d.l1_hit_rate_pct.toFixed(1) + '%%');\n  _anim('p_l2',   d.l2_hit_rate_pct.toFixed(1) + '%%');\n  _anim('p_ban',  d.banned_ips);\n  _anim('p_ecm',  _fmt(d.ecm_total));\n\n  var sp = document.getElementById('p_spe');\n  if (sp) sp.textContent = d.syscalls_per_ecm.toFixed(2);\n\n  var hr = document.getElementById('p_hr');\n  if (hr) hr.textContent = d.hit_rate_pct.toFixed(1) + '%%';\n\n  var hb = document.getElementById('p_hbf');\n  if (hb) hb.style.width = d.hit_rate_pct.toFixed(0) + '%%';\n\n  var ct = document.getElementById('p_caids');\n  if (ct && d.cw_caids) {\n    ct.innerHTML = d.cw_caids.length ? d.cw_caids.map(function(c) {\n      return '<tr>'\n        + '<td class=\"mono\"><span class=\"badge bbl\">' + _esc(c.caid) + '</span></td>'\n        + '<td class=\"mono bold\">' + c.ttl + 's</td>'\n        + '<td class=\"mono tm\">' + c.period_s + 's</td>'\n        + '<td class=\"mono tm\">' + c.lifetime_s + 's</td>'\n        + '<td class=\"mono\">' + c.samples + '</td>'\n   " \
+"     + '<td class=\"mono\">' + _fmt(c.lookups) + '</td>'\n        + '<td class=\"mono tg\">' + _fmt(c.hits) + '</td>'\n        + '<td class=\"mono\">' + _fmt(c.misses) + '</td>'\n        + '<td class=\"mono\">' + _fmt(c.coalesced) + '</td>'\n        + '<td class=\"mono\">' + _fmt(c.negative) + '</td>'\n        + '<td class=\"mono\">' + _fmt(c.expired) + '</td>'\n        + '<td class=\"mono' + (c.evictions > 0 ? ' to' : '') + '\">' + _fmt(c.evictions) + '</td>'\n        + '<td class=\"mono tm\">' + Math.floor(c.lock_wait_us / 1000) + 'ms</td>'\n        + '</tr>';\n    }).join('') : '<tr class=\"erow\"><td colspan=\"13\">No ECMs seen yet</td></tr>';\n  }\n\n  var tb = document.getElementById('p_clients');\n  if (!tb) return;\n\n  if (!d.clients || !d.clients.length) {\n    tb.innerHTML = '<tr class=\"erow\"><td colspan=\"8\">No active connections</td></tr>';\n    return;\n  }\n\n  /* Build index of live thread IDs */\n  var ids = {};\n  d.clients.forEach(function(cl) { ids[cl.thread_id] = 1; });\n\n  /* Fade out rows for disconnected clients */\n  Array.from(tb.querySelectorAll('tr[id^=\"row_\"]')).forEach(function(r) {\n    var tid = r.id.slice(4);\n    if (!ids[tid] && r.style.opacity !== '.4') {\n      r.style.opacity = '.4';\n      setTimeout(function() { if (r.parentNode) r.parentNode.removeChild(r); }, 800);\n    }\n  });\n\n  /* Add rows for new clients */\n  d.clients.forEach(function(cl) {\n    if (document.getElementById('row_' + cl.thread_id)) return;\n    var tr = document.createElement('tr');\n    tr.className = 'nw';\n    tr.id = 'row_' + cl.thread_id;\n    tr.innerHTML =\n      '<td class=\"bold\">' + _esc(cl.user) + '</td>'\n      + '<td class=\"mono\">' + _esc(cl.ip) + '</td>'\n      + '<td class=\"mono\"><span class=\"badge bbl\">' + _esc(cl.caid) + '</span></td>'\n      + '<td class=\"mono\">' + _esc(cl.sid) + '</td>'\n      + '<td>' + _esc(cl.channel || '&mdash;') + '</td>'\n      + '<td class=\"mono tm\">' + _esc(cl.connected) + '</td>'\n      + '<td class=\"mono tm\">' + _esc(cl.idle) + '</td>'\n      + '<td><button class=\"kb\" onclick=\"_kill(' + cl.thread_id\n        + ',\\'' + _esc(cl.user) + '\\')\" title=\"Disconnect\">&#x2715;</button></td>';\n    tb.appendChild(tr);\n  });\n}\n\n/* 6. Kill-client handler */\nfunction _kill(tid, user) {\n  if (!confirm('Disconnect ' + user + '?')) return;\n  fetch('/status?kill=' + tid + '&user=' + encodeURIComponent(user));\n  var r = document.getElementById('row_' + tid);\n  if (r) {\n    r.style.opacity = '.4';\n    setTimeout(function() { if (r.parentNode) r.parentNode.removeChild(r); }, 800);\n  }\n}\n\n/* 7. Poll loop */\nfunction _poll() {\n  if (_busy) return;\n  _busy = true;\n  fetch('/api/status', { cache: 'no-store' })\n    .then(function(r) {\n      if (r.status === 401) { window.location.href = '/login'; return null; }\n      if (!r.ok) return null;\n      return r.json();\n    })\n    .then(function(d) {\n      _busy = false;\n      if (!d) return;\n      _upd_topbar(d);\n      if (document.getElementById('p_clients')) _upd_status(d);\n    })\n    .catch(function() { _busy = false; });\n}\n\ndocument.addEventListener('DOMContentLoaded', function() {\n  if (_pm <= 0) return;\n  _poll();\n  _pit = setInterval(_poll, _pm);\n});\n"
+
+#endif
@@ -427,8 +427,11 @@ S_SERVER_STATS collect_stats(void)
 	pthread_rwlock_rdlock(&g_cfg.acc_lock);
 	s.naccounts = g_cfg.naccounts;
 	for (const S_ACCOUNT *a = g_cfg.accounts; a; a = a->next) {
-		s.cw_found += a->cw_found;
-		s.cw_not   += a->cw_not;
+		s.cw_found  += a->cw_found;
+		s.cw_not    += a->cw_not;
+		s.cw_neg    += a->cw_neg;
+		s.cw_l1_hit += a->cw_l1_hit;
+		s.cw_l2_hit += a->cw_l2_hit;
 	}
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
 
@@ -442,6 +445,24 @@ S_SERVER_STATS collect_stats(void)
 	s.hit_rate     = s.ecm_total > 0
 	               ? (double)s.cw_found * 100.0 / (double)s.ecm_total
 	               : 0.0;
+	s.l1_hit_rate  = s.ecm_total > 0
+	               ? (double)s.cw_l1_hit * 100.0 / (double)s.ecm_total
+	               : 0.0;
+	s.l2_hit_rate  = s.ecm_total > s.cw_l1_hit
+	               ? (double)s.cw_l2_hit * 100.0 / (double)(s.ecm_total - s.cw_l1_hit)
+	               : 0.0;
+	S_IO_STATS io;
+	engine_io_stats(&io);
+	s.io_recv_calls    = io.recv_calls;
+	s.io_send_calls    = io.send_calls;
+	s.io_ring_enters   = io.ring_enters;
+	s.ecm_expired      = io.ecm_expired;
+	s.ecm_shed         = io.ecm_shed;
+	s.ecm_queued       = io.ecm_queued;
+	s.ecm_lat_ms       = io.ecm_lat_ms;
+	s.syscalls_per_ecm = s.ecm_total > 0
+	               ? (double)(io.recv_calls + io.send_calls + io.ring_enters) / (double)s.ecm_total
+	               : 0.0;
 	s.active_conns = g_active_conns;
 	s.uptime_s     = now - g_start_time;
 	format_uptime(s.uptime_s, s.uptime_str, sizeof(s.uptime_str));
@@ -456,6 +477,9 @@ void handle_reset_stats(void)
 		a->ecm_total        = 0;
 		a->cw_found         = 0;
 		a->cw_not           = 0;
+		a->cw_neg           = 0;
+		a->cw_l1_hit        = 0;
+		a->cw_l2_hit        = 0;
 		a->cw_time_total_ms = 0;
 		a->cw_time_min_ms   = 0;
 		a->cw_time_max_ms   = 0;
@@ -464,6 +488,8 @@ void handle_reset_stats(void)
 		pthread_mutex_unlock(&a->stat_mtx);
 	}
 	pthread_rwlock_unlock(&g_cfg.acc_lock);
+	cw_cache_stats_reset();
+	engine_io_stats_reset();
 	tcmg_log("%s", "webif: all user stats reset");
 }
 
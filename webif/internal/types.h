@@ -20,8 +20,21 @@ typedef struct {
 typedef struct {
 	int64_t  cw_found;
 	int64_t  cw_not;
+	int64_t  cw_neg;
+	int64_t  cw_l1_hit;
+	int64_t  cw_l2_hit;
 	int64_t  ecm_total;
 	double   hit_rate;
+	double   l1_hit_rate;
+	double   l2_hit_rate;
+	uint64_t io_recv_calls;
+	uint64_t io_send_calls;
+	uint64_t io_ring_enters;
+	uint64_t ecm_expired;
+	uint64_t ecm_shed;
+	int32_t  ecm_queued;
+	int32_t  ecm_lat_ms;
+	double   syscalls_per_ecm;
 	int      nbans;
 	int      naccounts;
 	int      active_conns;
@@ -82,25 +82,32 @@ void send_page_status(int fd)
 	}
 
 	{
-		char ecm_val[24];
+		char ecm_val[24], ecm_sub[80];
 		snprintf(ecm_val, sizeof(ecm_val), "%lld", (long long)st.ecm_total);
+		snprintf(ecm_sub, sizeof(ecm_sub),
+		         "requests, <span id='p_spe'>%.2f</span> syscalls each", st.syscalls_per_ecm);
 		pos = emit_stat_card(&buf, &bsz, pos, "vi", ICO_ZAP,
-		    "ECM Total", "p_ecm", ecm_val, "requests", NULL);
+		    "ECM Total", "p_ecm", ecm_val, ecm_sub, NULL);
 	}
 
 	{
-		char cw_val[24];
+		char cw_val[24], cw_sub[96];
 		snprintf(cw_val, sizeof(cw_val), "%lld", (long long)st.cw_found);
+		snprintf(cw_sub, sizeof(cw_sub),
+		         "L1 <span id='p_l1'>%.1f%%</span>, L2 <span id='p_l2'>%.1f%%</span> cache hits",
+		         st.l1_hit_rate, st.l2_hit_rate);
 		pos = emit_stat_card(&buf, &bsz, pos, "gr", ICO_CHECK,
-		    "CW Found", "p_hit", cw_val, "cache hits", NULL);
+		    "CW Found", "p_hit", cw_val, cw_sub, NULL);
 	}
 
 	{
-		char miss_val[24];
+		char miss_val[24], miss_sub[64];
 		snprintf(miss_val, sizeof(miss_val), "%lld", (long long)st.cw_not);
+		snprintf(miss_sub, sizeof(miss_sub), "not found, <span id='p_neg'>%lld</span> cached",
+		         (long long)st.cw_neg);
 		pos = emit_stat_card(&buf, &bsz, pos,
 		    st.cw_not > 0 ? "re" : "bl", ICO_X,
-		    "CW Miss", "p_miss", miss_val, "not found", NULL);
+		    "CW Miss", "p_miss", miss_val, miss_sub, NULL);
 	}
 
 	pos = emit_stat_card(&buf, &bsz, pos, "cy", ICO_PERCENT,
@@ -151,6 +158,55 @@ void send_page_status(int fd)
 		"<tbody id='p_clients'>"
 		"</tbody></table></div>");
 
+	pos = buf_printf(&buf, &bsz, pos,
+		"<div class='shd' style='justify-content:center'>"
+		"  <div class='stl'>"
+		"    <svg width='15' height='15' viewBox='0 0 24 24' fill='none' stroke='var(--p)' stroke-width='1.8' style='flex-shrink:0'>"
+		"      <circle cx='12' cy='12' r='10'/><polyline points='12 6 12 12 16 14'/>"
+		"    </svg>CW Cache by CAID"
+		"  </div>"
+		"</div>"
+		"<div class='tw'><table>"
+		"<thead><tr>"
+		"<th>CAID</th><th>TTL</th><th>Crypto Period</th><th>ECM Lifetime</th><th>Samples</th>"
+		"<th>Lookups</th><th>Hits</th><th>Misses</th><th>Coalesced</th><th>Negative</th><th>Expired</th><th>Evictions</th><th>Lock Wait</th>"
+		"</tr></thead>"
+		"<tbody id='p_caids'>");
+
+	{
+		S_CW_CAID_INFO ci[CW_CACHE_CAIDS];
+		int32_t nci = cw_cache_caid_info(ci, CW_CACHE_CAIDS);
+		for (int32_t i = 0; i < nci; i++)
+			pos = buf_printf(&buf, &bsz, pos,
+				"<tr>"
+				"<td class='mono'><span class='badge bbl'>%04X</span></td>"
+				"<td class='mono bold'>%ds</td>"
+				"<td class='mono tm'>%ds</td>"
+				"<td class='mono tm'>%ds</td>"
+				"<td class='mono'>%u</td>"
+				"<td class='mono'>%llu</td>"
+				"<td class='mono tg'>%llu</td>"
+				"<td class='mono'>%llu</td>"
+				"<td class='mono'>%llu</td>"
+				"<td class='mono'>%llu</td>"
+				"<td class='mono'>%llu</td>"
+				"<td class='mono%s'>%llu</td>"
+				"<td class='mono tm'>%llums</td>"
+				"</tr>",
+				ci[i].caid, ci[i].ttl, ci[i].period_s, ci[i].lifetime_s, ci[i].samples,
+				(unsigned long long)ci[i].lookups, (unsigned long long)ci[i].hits,
+				(unsigned long long)ci[i].misses, (unsigned long long)ci[i].coalesced,
+				(unsigned long long)ci[i].negative,
+				(unsigned long long)ci[i].expired,
+				ci[i].evictions > 0 ? " to" : "", (unsigned long long)ci[i].evictions,
+				(unsigned long long)(ci[i].lock_wait_us / 1000));
+		if (!nci)
+			pos = buf_printf(&buf, &bsz, pos,
+				"<tr class='erow'><td colspan='13'>No ECMs seen yet</td></tr>");
+	}
+
+	pos = buf_printf(&buf, &bsz, pos, "</tbody></table></div>");
+
 	pos = emit_footer(&buf, &bsz, pos);
 	PAGE_SEND_AND_FREE(fd);
 }
@@ -2,6 +2,32 @@
 #include "../../globals.h"
 #include "../internal/proto.h"
 
+typedef struct { char user[64]; char ip[MAXIPLEN]; char proto[12]; time_t last_ecm; } cl_snap;
+
+typedef struct {
+	cl_snap *snaps;
+	int      n;
+	int      cap;
+} S_USERS_SNAP;
+
+static void users_snap_client(S_CLIENT *cl, void *arg)
+{
+	S_USERS_SNAP *us  = (S_USERS_SNAP *)arg;
+	S_ACCOUNT    *acc = cl->account;
+	if (!acc) return;
+	if (us->n == us->cap) {
+		int      cap = us->cap ? us->cap * 2 : 64;
+		cl_snap *p   = (cl_snap *)realloc(us->snaps, sizeof(cl_snap) * (size_t)cap);
+		if (!p) return;
+		us->snaps = p;
+		us->cap   = cap;
+	}
+	cl_snap *sn = &us->snaps[us->n++];
+	tcmg_strlcpy(sn->user,  acc->user, 64);
+	tcmg_strlcpy(sn->ip,    cl->ip, MAXIPLEN);
+	tcmg_strlcpy(sn->proto, cl->proto[0] ? cl->proto : "unknown", 12);
+	sn->last_ecm = cl->last_ecm_time;
+}
 
 void send_page_users(int fd)
 {
@@ -72,22 +98,10 @@ void send_page_users(int fd)
 		"<th>Expiry</th><th></th>"
 		"</tr></thead><tbody id='usrBody'>");
 
-	typedef struct { char user[64]; char ip[MAXIPLEN]; char proto[12]; time_t last_ecm; } cl_snap;
-	cl_snap *snaps = (cl_snap *)calloc(MAX_ACTIVE_CLIENTS, sizeof(cl_snap));
-	int nsnaps = 0;
-	if (snaps) {
-		pthread_mutex_lock(&g_clients_mtx);
-		for (int ci = 0; ci < MAX_ACTIVE_CLIENTS; ci++) {
-			S_CLIENT *cl = g_clients[ci];
-			if (!cl || !cl->account) continue;
-			tcmg_strlcpy(snaps[nsnaps].user,  cl->account->user, 64);
-			tcmg_strlcpy(snaps[nsnaps].ip,    cl->ip, MAXIPLEN);
-			tcmg_strlcpy(snaps[nsnaps].proto, cl->proto[0] ? cl->proto : "unknown", 12);
-			snaps[nsnaps].last_ecm = cl->last_ecm_time;
-			nsnaps++;
-		}
-		pthread_mutex_unlock(&g_clients_mtx);
-	}
+	S_USERS_SNAP us = { NULL, 0, 0 };
+	clients_foreach(users_snap_client, &us);
+	cl_snap *snaps  = us.snaps;
+	int      nsnaps = us.n;
 
 	pthread_rwlock_rdlock(&g_cfg.acc_lock);
 	int row = 0;
@@ -231,11 +231,7 @@ static void *http_server_thread(void *arg)
 	         g_cfg.webif_port);
 
 	while (atomic_load_explicit(&s_webif_running, memory_order_acquire)) {
-		fd_set rfds;
-		FD_ZERO(&rfds);
-		FD_SET(s_webif_sock, &rfds);
-		struct timeval tv = { 1, 0 };
-		if (select(s_webif_sock + 1, &rfds, NULL, NULL, &tv) <= 0)
+		if (tcmg_poll_in(s_webif_sock, 1000) <= 0)
 			continue;
 
 		struct sockaddr_in ca;